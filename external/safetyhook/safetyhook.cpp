@@ -25,6 +25,7 @@
 #include <cstdint>
 #include <expected>
 #include <functional>
+#include <vector>
 #else
 import std.compat;
 #endif
@@ -85,8 +86,18 @@ SystemInfo system_info();
 
 using ThreadContext = void*;
 
+struct TrapRange {
+    uint8_t* from;
+    uint8_t* to;
+    size_t len;
+};
+
 void trap_threads(uint8_t* from, uint8_t* to, size_t len, const std::function<void()>& run_fn);
 
+/// @brief Traps every range at once, runs run_fn, then releases them all.
+/// @details Same as nesting trap_threads for each range, with one protect/unprotect per range.
+void trap_threads(const std::vector<TrapRange>& ranges, const std::function<void()>& run_fn);
+
 /// @brief Will modify the context of a thread's IP to point to a new address if its IP is at the old address.
 /// @param ctx The thread context to modify.
 /// @param old_ip The old IP address.
@@ -155,6 +166,44 @@ std::shared_ptr<Allocator> Allocator::create() {
     return std::shared_ptr<Allocator>{new Allocator{}};
 }
 
+std::expected<std::shared_ptr<Allocator>, Allocator::Error> Allocator::create_reserved(
+    const std::vector<uint8_t*>& desired_addresses, size_t size, size_t max_distance) {
+    auto allocator = create();
+    auto block_size = align_up(size, system_info().allocation_granularity);
+    auto block_address = allocate_nearby_memory(desired_addresses, block_size, max_distance);
+
+    if (!block_address) {
+        return std::unexpected{block_address.error()};
+    }
+
+    auto& block = allocator->m_memory.emplace_back(new Memory);
+
+    block->address = *block_address;
+    block->size = block_size;
+    block->freelist = std::make_unique<FreeNode>();
+    block->freelist->start = *block_address;
+    block->freelist->end = *block_address + block_size;
+
+    return allocator;
+}
+
+std::vector<Allocator::Block> Allocator::blocks() {
+    std::scoped_lock lock{m_mutex};
+    std::vector<Block> blocks{};
+
+    for (const auto& memory : m_memory) {
+        size_t free = 0;
+
+        for (auto node = memory->freelist.get(); node != nullptr; node = node->next.get()) {
+            free += static_cast<size_t>(node->end - node->start);
+        }
+
+        blocks.push_back({.address = memory->address, .size = memory->size, .free = free});
+    }
+
+    return blocks;
+}
+
 std::expected<Allocation, Allocator::Error> Allocator::allocate(size_t size) {
     return allocate_near({}, size, std::numeric_limits<size_t>::max());
 }
@@ -767,6 +816,28 @@ std::expected<void, InlineHook::Error> InlineHook::ff_hook(const std::shared_ptr
 }
 #endif
 
+std::expected<void, InlineHook::Error> InlineHook::write_jmp() {
+    if (m_type == Type::E9) {
+        auto trampoline_epilogue = reinterpret_cast<TrampolineEpilogueE9*>(
+            m_trampoline.address() + m_trampoline_size - sizeof(TrampolineEpilogueE9));
+
+        return emit_jmp_e9(
+            m_target, reinterpret_cast<uint8_t*>(&trampoline_epilogue->jmp_to_destination), m_original_bytes.size());
+    }
+
+#if SAFETYHOOK_ARCH_X86_64
+    if (m_type == Type::FF) {
+        return emit_jmp_ff(m_target, m_destination, m_target + sizeof(JmpFF), m_original_bytes.size());
+    }
+#endif
+
+    return {};
+}
+
+void InlineHook::write_original() {
+    std::copy(m_original_bytes.begin(), m_original_bytes.end(), m_target);
+}
+
 std::expected<void, InlineHook::Error> InlineHook::enable() {
     std::scoped_lock lock{m_mutex};
 
@@ -778,25 +849,9 @@ std::expected<void, InlineHook::Error> InlineHook::enable() {
 
     // jmp from original to trampoline.
     trap_threads(m_target, m_trampoline.data(), m_original_bytes.size(), [this, &error] {
-        if (m_type == Type::E9) {
-            auto trampoline_epilogue = reinterpret_cast<TrampolineEpilogueE9*>(
-                m_trampoline.address() + m_trampoline_size - sizeof(TrampolineEpilogueE9));
-
-            if (auto result = emit_jmp_e9(m_target,
-                    reinterpret_cast<uint8_t*>(&trampoline_epilogue->jmp_to_destination), m_original_bytes.size());
-                !result) {
-                error = result.error();
-            }
+        if (auto result = write_jmp(); !result) {
+            error = result.error();
         }
-
-#if SAFETYHOOK_ARCH_X86_64
-        if (m_type == Type::FF) {
-            if (auto result = emit_jmp_ff(m_target, m_destination, m_target + sizeof(JmpFF), m_original_bytes.size());
-                !result) {
-                error = result.error();
-            }
-        }
-#endif
     });
 
     if (error) {
@@ -815,8 +870,7 @@ std::expected<void, InlineHook::Error> InlineHook::disable() {
         return {};
     }
 
-    trap_threads(m_trampoline.data(), m_target, m_original_bytes.size(),
-        [this] { std::copy(m_original_bytes.begin(), m_original_bytes.end(), m_target); });
+    trap_threads(m_trampoline.data(), m_target, m_original_bytes.size(), [this] { write_original(); });
 
     m_enabled = false;
 
@@ -928,6 +982,30 @@ std::expected<MidHook, MidHook::Error> MidHook::create(
     return hook;
 }
 
+std::expected<MidHook, MidHook::Error> MidHook::create_lean(
+    void* target, MidRegisters registers, MidHookFn destination, Flags flags) {
+    return create_lean(Allocator::global(), target, registers, destination, flags);
+}
+
+std::expected<MidHook, MidHook::Error> MidHook::create_lean(const std::shared_ptr<Allocator>& allocator,
+    void* target, MidRegisters registers, MidHookFn destination, Flags flags) {
+    MidHook hook{};
+
+    if (const auto setup_result =
+            hook.setup(allocator, reinterpret_cast<uint8_t*>(target), destination, registers);
+        !setup_result) {
+        return std::unexpected{setup_result.error()};
+    }
+
+    if (!(flags & StartDisabled)) {
+        if (auto enable_result = hook.enable(); !enable_result) {
+            return std::unexpected{enable_result.error()};
+        }
+    }
+
+    return hook;
+}
+
 MidHook::MidHook(MidHook&& other) noexcept {
     *this = std::move(other);
 }
@@ -938,9 +1016,11 @@ MidHook& MidHook::operator=(MidHook&& other) noexcept {
         m_target = other.m_target;
         m_stub = std::move(other.m_stub);
         m_destination = other.m_destination;
+        m_registers = other.m_registers;
 
         other.m_target = 0;
         other.m_destination = nullptr;
+        other.m_registers = reg::all;
     }
 
     return *this;
@@ -950,12 +1030,31 @@ void MidHook::reset() {
     *this = {};
 }
 
-std::expected<void, MidHook::Error> MidHook::setup(
-    const std::shared_ptr<Allocator>& allocator, uint8_t* target, MidHookFn destination_fn) {
+std::expected<void, MidHook::Error> MidHook::setup(const std::shared_ptr<Allocator>& allocator, uint8_t* target,
+    MidHookFn destination_fn, MidRegisters registers) {
     m_target = target;
     m_destination = destination_fn;
 
-    auto stub_allocation = allocator->allocate(asm_data.size());
+#if SAFETYHOOK_ARCH_X86_64
+    m_registers = registers;
+
+    std::vector<uint8_t> lean_stub{};
+
+    if (m_registers != reg::all) {
+        lean_stub = make_lean_mid_stub(m_registers);
+    }
+
+    const auto* stub_data = lean_stub.empty() ? asm_data.data() : lean_stub.data();
+    const auto stub_size = lean_stub.empty() ? asm_data.size() : lean_stub.size();
+#elif SAFETYHOOK_ARCH_X86_32
+    // No lean stubs on 32-bit, the full context is always saved.
+    m_registers = reg::all;
+
+    const auto* stub_data = asm_data.data();
+    const auto stub_size = asm_data.size();
+#endif
+
+    auto stub_allocation = allocator->allocate(stub_size);
 
     if (!stub_allocation) {
         return std::unexpected{Error::bad_allocation(stub_allocation.error())};
@@ -963,10 +1062,10 @@ std::expected<void, MidHook::Error> MidHook::setup(
 
     m_stub = std::move(*stub_allocation);
 
-    std::copy(asm_data.begin(), asm_data.end(), m_stub.data());
+    std::copy_n(stub_data, stub_size, m_stub.data());
 
 #if SAFETYHOOK_ARCH_X86_64
-    store(m_stub.data() + sizeof(asm_data) - 16, m_destination);
+    store(m_stub.data() + stub_size - 16, m_destination);
 #elif SAFETYHOOK_ARCH_X86_32
     store(m_stub.data() + sizeof(asm_data) - 8, m_destination);
 
@@ -985,7 +1084,7 @@ std::expected<void, MidHook::Error> MidHook::setup(
     m_hook = std::move(*hook_result);
 
 #if SAFETYHOOK_ARCH_X86_64
-    store(m_stub.data() + sizeof(asm_data) - 8, m_hook.trampoline().data());
+    store(m_stub.data() + stub_size - 8, m_hook.trampoline().data());
 #elif SAFETYHOOK_ARCH_X86_32
     store(m_stub.data() + sizeof(asm_data) - 4, m_hook.trampoline().data());
 #endif
@@ -1010,6 +1109,110 @@ std::expected<void, MidHook::Error> MidHook::disable() {
 }
 } // namespace safetyhook
 
+//
+// Source file: transaction.cpp
+//
+
+#include <algorithm>
+#include <mutex>
+#include <optional>
+
+
+
+namespace safetyhook {
+std::expected<void, InlineHook::Error> Transaction::commit() {
+    auto hooks = std::move(m_hooks);
+    m_hooks.clear();
+
+    // Already enabled hooks are left alone, duplicates are only patched once.
+    std::sort(hooks.begin(), hooks.end());
+    hooks.erase(std::unique(hooks.begin(), hooks.end()), hooks.end());
+
+    std::vector<std::unique_lock<std::recursive_mutex>> locks;
+    std::vector<InlineHook*> pending;
+    std::vector<TrapRange> ranges;
+
+    for (auto* hook : hooks) {
+        locks.emplace_back(hook->m_mutex);
+
+        if (hook->m_enabled || !hook->m_trampoline) {
+            continue;
+        }
+
+        pending.push_back(hook);
+        ranges.push_back({.from = hook->m_target, .to = hook->m_trampoline.data(), .len = hook->m_original_bytes.size()});
+    }
+
+    if (pending.empty()) {
+        return {};
+    }
+
+    std::optional<InlineHook::Error> error;
+
+    trap_threads(ranges, [&] {
+        for (size_t i = 0; i < pending.size(); ++i) {
+            if (auto result = pending[i]->write_jmp(); !result) {
+                error = result.error();
+
+                // Roll back every jmp written so far, including a partially written one.
+                for (size_t j = 0; j <= i; ++j) {
+                    pending[j]->write_original();
+                }
+
+                return;
+            }
+        }
+    });
+
+    if (error) {
+        return std::unexpected{*error};
+    }
+
+    for (auto* hook : pending) {
+        hook->m_enabled = true;
+    }
+
+    return {};
+}
+
+void Transaction::revert() {
+    auto hooks = std::move(m_hooks);
+    m_hooks.clear();
+
+    std::sort(hooks.begin(), hooks.end());
+    hooks.erase(std::unique(hooks.begin(), hooks.end()), hooks.end());
+
+    std::vector<std::unique_lock<std::recursive_mutex>> locks;
+    std::vector<InlineHook*> pending;
+    std::vector<TrapRange> ranges;
+
+    for (auto* hook : hooks) {
+        locks.emplace_back(hook->m_mutex);
+
+        if (!hook->m_enabled) {
+            continue;
+        }
+
+        pending.push_back(hook);
+        ranges.push_back({.from = hook->m_trampoline.data(), .to = hook->m_target, .len = hook->m_original_bytes.size()});
+    }
+
+    if (pending.empty()) {
+        return;
+    }
+
+    trap_threads(ranges, [&] {
+        for (auto* hook : pending) {
+            hook->write_original();
+        }
+    });
+
+    for (auto* hook : pending) {
+        hook->m_enabled = false;
+    }
+}
+} // namespace safetyhook
+
 //
 // Source file: os.linux.cpp
 //
@@ -1200,11 +1403,25 @@ SystemInfo system_info() {
 
 void trap_threads([[maybe_unused]] uint8_t* from, [[maybe_unused]] uint8_t* to, [[maybe_unused]] size_t len,
     const std::function<void()>& run_fn) {
-    auto from_protect = vm_protect(from, len, VM_ACCESS_RWX).value_or(0);
-    auto to_protect = vm_protect(to, len, VM_ACCESS_RWX).value_or(0);
+    trap_threads({TrapRange{.from = from, .to = to, .len = len}}, run_fn);
+}
+
+void trap_threads(const std::vector<TrapRange>& ranges, const std::function<void()>& run_fn) {
+    std::vector<std::pair<uint32_t, uint32_t>> protects;
+
+    for (const auto& range : ranges) {
+        auto from_protect = vm_protect(range.from, range.len, VM_ACCESS_RWX).value_or(0);
+        auto to_protect = vm_protect(range.to, range.len, VM_ACCESS_RWX).value_or(0);
+        protects.emplace_back(from_protect, to_protect);
+    }
+
     run_fn();
-    vm_protect(to, len, to_protect);
-    vm_protect(from, len, from_protect);
+
+    // Restore in reverse so ranges sharing a page end up with the page's original protection.
+    for (size_t i = ranges.size(); i-- > 0;) {
+        vm_protect(ranges[i].to, ranges[i].len, protects[i].second);
+        vm_protect(ranges[i].from, ranges[i].len, protects[i].first);
+    }
 }
 
 void fix_ip([[maybe_unused]] ThreadContext ctx, [[maybe_unused]] uint8_t* old_ip, [[maybe_unused]] uint8_t* new_ip) {
@@ -1476,30 +1693,17 @@ void find_me() {
 }
 
 void trap_threads(uint8_t* from, uint8_t* to, size_t len, const std::function<void()>& run_fn) {
-    MEMORY_BASIC_INFORMATION find_me_mbi{};
-    MEMORY_BASIC_INFORMATION from_mbi{};
-    MEMORY_BASIC_INFORMATION to_mbi{};
+    trap_threads({TrapRange{.from = from, .to = to, .len = len}}, run_fn);
+}
 
+void trap_threads(const std::vector<TrapRange>& ranges, const std::function<void()>& run_fn) {
+    MEMORY_BASIC_INFORMATION find_me_mbi{};
     VirtualQuery(reinterpret_cast<void*>(find_me), &find_me_mbi, sizeof(find_me_mbi));
-    VirtualQuery(from, &from_mbi, sizeof(from_mbi));
-    VirtualQuery(to, &to_mbi, sizeof(to_mbi));
-
-    auto new_protect = PAGE_READWRITE;
-
-    if (from_mbi.AllocationBase == find_me_mbi.AllocationBase || to_mbi.AllocationBase == find_me_mbi.AllocationBase) {
-        new_protect = PAGE_EXECUTE_READWRITE;
-    }
 
     auto si = system_info();
-    auto *from_page_start = align_down(from, si.page_size);
-    auto *from_page_end = align_up(from + len, si.page_size);
     auto *vp_start = reinterpret_cast<uint8_t*>(&VirtualProtect);
     auto *vp_end = vp_start + 0x20;
 
-    if (!(from_page_end < vp_start || vp_end < from_page_start)){
-        new_protect = PAGE_EXECUTE_READWRITE;
-    }
-
     if (!TrapManager::is_destructed) {
         std::scoped_lock lock{TrapManager::mutex};
 
@@ -1507,21 +1711,50 @@ void trap_threads(uint8_t* from, uint8_t* to, size_t len, const std::function<vo
             TrapManager::instance = std::make_unique<TrapManager>();
         }
 
-        TrapManager::instance->add_trap(from, to, len);
+        for (const auto& range : ranges) {
+            TrapManager::instance->add_trap(range.from, range.to, range.len);
+        }
     }
 
-    DWORD from_protect;
-    DWORD to_protect;
+    std::vector<std::pair<DWORD, DWORD>> protects;
+
+    for (const auto& [from, to, len] : ranges) {
+        MEMORY_BASIC_INFORMATION from_mbi{};
+        MEMORY_BASIC_INFORMATION to_mbi{};
+
+        VirtualQuery(from, &from_mbi, sizeof(from_mbi));
+        VirtualQuery(to, &to_mbi, sizeof(to_mbi));
 
-    VirtualProtect(from, len, new_protect, &from_protect);
-    VirtualProtect(to, len, new_protect, &to_protect);
+        auto new_protect = PAGE_READWRITE;
+
+        if (from_mbi.AllocationBase == find_me_mbi.AllocationBase || to_mbi.AllocationBase == find_me_mbi.AllocationBase) {
+            new_protect = PAGE_EXECUTE_READWRITE;
+        }
+
+        auto *from_page_start = align_down(from, si.page_size);
+        auto *from_page_end = align_up(from + len, si.page_size);
+
+        if (!(from_page_end < vp_start || vp_end < from_page_start)){
+            new_protect = PAGE_EXECUTE_READWRITE;
+        }
+
+        DWORD from_protect;
+        DWORD to_protect;
+
+        VirtualProtect(from, len, new_protect, &from_protect);
+        VirtualProtect(to, len, new_protect, &to_protect);
+        protects.emplace_back(from_protect, to_protect);
+    }
 
     if (run_fn) {
         run_fn();
     }
 
-    VirtualProtect(to, len, to_protect, &to_protect);
-    VirtualProtect(from, len, from_protect, &from_protect);
+    // Restore in reverse so ranges sharing a page end up with the page's original protection.
+    for (size_t i = ranges.size(); i-- > 0;) {
+        VirtualProtect(ranges[i].to, ranges[i].len, protects[i].second, &protects[i].second);
+        VirtualProtect(ranges[i].from, ranges[i].len, protects[i].first, &protects[i].first);
+    }
 }
 
 void fix_ip(ThreadContext thread_ctx, uint8_t* old_ip, uint8_t* new_ip) {
@@ -137,6 +137,27 @@ public:
         NO_MEMORY_IN_RANGE, ///< No memory in range.
     };
 
+    /// @brief Creates a new Allocator with one block reserved up front near the target addresses.
+    /// @details Allocations are served first-fit from the block, so things allocated one after another end up next
+    /// to each other. A new block is only reserved once the first is full or out of range.
+    /// @param desired_addresses The target addresses.
+    /// @param size The size of the block, rounded up to the allocation granularity.
+    /// @param max_distance The maximum distance from the target addresses.
+    /// @return The new Allocator or an Allocator::Error if the block couldn't be reserved.
+    [[nodiscard]] static std::expected<std::shared_ptr<Allocator>, Error> create_reserved(
+        const std::vector<uint8_t*>& desired_addresses, size_t size, size_t max_distance = 0x7FFF'FFFF);
+
+    /// @brief A block of memory reserved by an Allocator.
+    struct Block {
+        uint8_t* address; ///< Start of the block.
+        size_t size;      ///< Size of the block.
+        size_t free;      ///< Bytes not allocated.
+    };
+
+    /// @brief Returns the blocks this Allocator has reserved, in the order they were reserved.
+    /// @return The blocks.
+    [[nodiscard]] std::vector<Block> blocks();
+
     /// @brief Allocates memory.
     /// @param size The size of the allocation.
     /// @return The Allocation or an Allocator::Error if the allocation failed.
@@ -632,6 +653,7 @@ public:
 
 private:
     friend class MidHook;
+    friend class Transaction;
 
     enum class Type {
         Unset,
@@ -656,6 +678,12 @@ private:
     std::expected<void, Error> ff_hook(const std::shared_ptr<Allocator>& allocator);
 #endif
 
+    // Writes the jmp to the trampoline/destination. Memory must already be writable.
+    std::expected<void, Error> write_jmp();
+
+    // Restores the original bytes. Memory must already be writable.
+    void write_original();
+
     void destroy();
 };
 } // namespace safetyhook
@@ -675,7 +703,9 @@ private:
 
 #ifndef SAFETYHOOK_USE_CXXMODULES
 #include <cstdint>
+#include <initializer_list>
 #include <memory>
+#include <vector>
 #else
 import std.compat;
 #endif
@@ -752,6 +782,170 @@ namespace safetyhook {
 /// @brief A MidHook destination function.
 using MidHookFn = void (*)(Context& ctx);
 
+/// @brief A set of registers a lean MidHook's destination reads or writes (see MidHook::create_lean).
+/// @details Bits follow the order of the Context64 fields. rflags and rip are always saved.
+using MidRegisters = uint32_t;
+
+/// @brief Register bits for MidRegisters.
+namespace reg {
+enum : MidRegisters {
+    xmm0 = 1u << 0,
+    xmm1 = 1u << 1,
+    xmm2 = 1u << 2,
+    xmm3 = 1u << 3,
+    xmm4 = 1u << 4,
+    xmm5 = 1u << 5,
+    xmm6 = 1u << 6,
+    xmm7 = 1u << 7,
+    xmm8 = 1u << 8,
+    xmm9 = 1u << 9,
+    xmm10 = 1u << 10,
+    xmm11 = 1u << 11,
+    xmm12 = 1u << 12,
+    xmm13 = 1u << 13,
+    xmm14 = 1u << 14,
+    xmm15 = 1u << 15,
+    r15 = 1u << 16,
+    r14 = 1u << 17,
+    r13 = 1u << 18,
+    r12 = 1u << 19,
+    r11 = 1u << 20,
+    r10 = 1u << 21,
+    r9 = 1u << 22,
+    r8 = 1u << 23,
+    rdi = 1u << 24,
+    rsi = 1u << 25,
+    rdx = 1u << 26,
+    rcx = 1u << 27,
+    rbx = 1u << 28,
+    rax = 1u << 29,
+    rbp = 1u << 30,
+    rsp = 1u << 31, ///< Read-only, like in a full MidHook.
+    all = 0xFFFFFFFFu,
+};
+} // namespace reg
+
+#if SAFETYHOOK_ARCH_X86_64
+/// @brief Calling convention of a lean stub's destination.
+enum class MidStubAbi : uint8_t {
+    Win64,
+    SysV,
+#if SAFETYHOOK_OS_WINDOWS
+    Native = Win64,
+#else
+    Native = SysV,
+#endif
+};
+
+/// @brief Builds a MidHook stub that only saves the registers the destination uses.
+/// @details The destination still gets a full Context64, laid out on the stack as usual, but only the slots of the
+/// given registers are filled in and written back. Registers the destination may clobber under the ABI (and rbx,
+/// which the stub uses itself) are always saved so the hooked code never sees a difference. Everything else is
+/// callee-saved and left alone, which on Win64 skips xmm6-xmm15 and the non-volatile GPRs.
+/// @param registers The registers the destination reads or writes.
+/// @param abi The destination's calling convention.
+/// @return The stub. The last 16 bytes are the destination and the trampoline address, filled in by the caller.
+/// @note Slots of registers that weren't given hold garbage, and writes to them are lost. trampoline_rsp is not
+/// supported, rip is.
+[[nodiscard]] inline std::vector<uint8_t> make_lean_mid_stub(MidRegisters registers, MidStubAbi abi = MidStubAbi::Native) {
+    // Context64 layout: xmm0-xmm15, then rflags, r15 ... rbp, rsp, trampoline_rsp, rip.
+    constexpr int32_t rflags_offset = 0x100;
+    constexpr int32_t rsp_offset = 0x180;
+    constexpr int32_t frame_size = 0x198;
+    constexpr uint8_t gpr_numbers[] = {15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 2, 1, 3, 0, 5}; // r15 ... rbp
+
+    registers |= reg::rax | reg::rcx | reg::rdx | reg::r8 | reg::r9 | reg::r10 | reg::r11 | reg::rbx;
+    if (abi == MidStubAbi::Win64) {
+        registers |= reg::xmm0 | reg::xmm1 | reg::xmm2 | reg::xmm3 | reg::xmm4 | reg::xmm5;
+    } else {
+        registers |= reg::rsi | reg::rdi | 0xFFFFu;
+    }
+
+    std::vector<uint8_t> code;
+    auto emit = [&](std::initializer_list<uint8_t> bytes) { code.insert(code.end(), bytes); };
+    auto emit32 = [&](int32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            code.push_back(static_cast<uint8_t>(static_cast<uint32_t>(value) >> (i * 8)));
+        }
+    };
+    auto lea_rsp = [&](int32_t disp) {
+        emit({0x48, 0x8D, 0xA4, 0x24});
+        emit32(disp);
+    };
+    // mov [rsp+disp], gpr (0x89) or mov gpr, [rsp+disp] (0x8B)
+    auto mov_gpr = [&](uint8_t opcode, uint8_t gpr, int32_t disp) {
+        emit({static_cast<uint8_t>(gpr >= 8 ? 0x4C : 0x48), opcode, static_cast<uint8_t>(0x84 | ((gpr & 7) << 3)), 0x24});
+        emit32(disp);
+    };
+    // movdqu [rsp+disp], xmm (0x7F) or movdqu xmm, [rsp+disp] (0x6F)
+    auto mov_xmm = [&](uint8_t opcode, uint8_t xmm, int32_t disp) {
+        emit({0xF3});
+        if (xmm >= 8) {
+            emit({0x44});
+        }
+        emit({0x0F, opcode, static_cast<uint8_t>(0x84 | ((xmm & 7) << 3)), 0x24});
+        emit32(disp);
+    };
+
+    // push [rip+trampoline] into the rip slot, then rflags into its slot before anything can change them. lea
+    // leaves the flags alone.
+    emit({0xFF, 0x35});
+    const auto trampoline_ref = code.size();
+    emit32(0);
+    lea_rsp(-(frame_size - 8 - (rflags_offset + 8)));
+    emit({0x9C});
+    lea_rsp(-rflags_offset);
+
+    for (int i = 0; i < 15; ++i) {
+        if (registers & (1u << (16 + i))) {
+            mov_gpr(0x89, gpr_numbers[i], rflags_offset + 8 + i * 8);
+        }
+    }
+    if (registers & reg::rsp) {
+        // lea rax, [rsp+frame_size] ; mov [rsp+rsp_offset], rax (rax is saved already)
+        emit({0x48, 0x8D, 0x84, 0x24});
+        emit32(frame_size);
+        mov_gpr(0x89, 0, rsp_offset);
+    }
+    for (uint8_t i = 0; i < 16; ++i) {
+        if (registers & (1u << i)) {
+            mov_xmm(0x7F, i, i * 16);
+        }
+    }
+
+    // mov rbx, rsp ; lea rcx/rdi, [rsp] ; sub rsp, 0x20 ; and rsp, -16 ; call [rip+destination] ; mov rsp, rbx
+    emit({0x48, 0x89, 0xE3});
+    emit({0x48, 0x8D, static_cast<uint8_t>(abi == MidStubAbi::Win64 ? 0x0C : 0x3C), 0x24});
+    emit({0x48, 0x83, 0xEC, 0x20, 0x48, 0x83, 0xE4, 0xF0, 0xFF, 0x15});
+    const auto destination_ref = code.size();
+    emit32(0);
+    emit({0x48, 0x89, 0xDC});
+
+    for (uint8_t i = 0; i < 16; ++i) {
+        if (registers & (1u << i)) {
+            mov_xmm(0x6F, i, i * 16);
+        }
+    }
+    for (int i = 0; i < 15; ++i) {
+        if (registers & (1u << (16 + i))) {
+            mov_gpr(0x8B, gpr_numbers[i], rflags_offset + 8 + i * 8);
+        }
+    }
+
+    // Back up to the rflags slot, pop them, then return through the rip slot.
+    lea_rsp(rflags_offset);
+    emit({0x9D});
+    lea_rsp(frame_size - 8 - (rflags_offset + 8));
+    emit({0xC3});
+
+    const auto data = static_cast<int32_t>(code.size());
+    store(code.data() + destination_ref, data - static_cast<int32_t>(destination_ref + 4));
+    store(code.data() + trampoline_ref, data + 8 - static_cast<int32_t>(trampoline_ref + 4));
+    code.resize(code.size() + 16, 0x00);
+    return code;
+}
+#endif
+
 /// @brief A mid function hook.
 class MidHook final {
 public:
@@ -837,6 +1031,28 @@ public:
         return create(allocator, reinterpret_cast<void*>(target), destination_fn, flags);
     }
 
+    /// @brief Creates a new MidHook object whose stub only saves the registers the destination uses.
+    /// @param target The address of the function to hook.
+    /// @param registers The registers the destination reads or writes (e.g. reg::xmm5 | reg::rdx).
+    /// @param destination_fn The destination function.
+    /// @param flags The flags to use.
+    /// @return The MidHook object or a MidHook::Error if an error occurred.
+    /// @note This will use the default global Allocator.
+    /// @note See make_lean_mid_stub for what the destination can rely on. On 32-bit this is the same as create.
+    [[nodiscard]] static std::expected<MidHook, Error> create_lean(
+        void* target, MidRegisters registers, MidHookFn destination_fn, Flags flags = Default);
+
+    /// @brief Creates a new MidHook object whose stub only saves the registers the destination uses.
+    /// @param allocator The Allocator to use.
+    /// @param target The address of the function to hook.
+    /// @param registers The registers the destination reads or writes (e.g. reg::xmm5 | reg::rdx).
+    /// @param destination_fn The destination function.
+    /// @param flags The flags to use.
+    /// @return The MidHook object or a MidHook::Error if an error occurred.
+    /// @note See make_lean_mid_stub for what the destination can rely on. On 32-bit this is the same as create.
+    [[nodiscard]] static std::expected<MidHook, Error> create_lean(const std::shared_ptr<Allocator>& allocator,
+        void* target, MidRegisters registers, MidHookFn destination_fn, Flags flags = Default);
+
     MidHook() = default;
     MidHook(const MidHook&) = delete;
     MidHook(MidHook&& other) noexcept;
@@ -861,6 +1077,18 @@ public:
     /// @return The destination function.
     [[nodiscard]] MidHookFn destination() const { return m_destination; }
 
+    /// @brief Get the stub that saves the context and calls the destination.
+    /// @return The stub's allocation.
+    [[nodiscard]] const Allocation& stub() const { return m_stub; }
+
+    /// @brief Get the trampoline holding the displaced instructions.
+    /// @return The trampoline's allocation.
+    [[nodiscard]] const Allocation& trampoline() const { return m_hook.trampoline(); }
+
+    /// @brief Get the registers the stub saves for the destination.
+    /// @return reg::all unless the hook was created with create_lean.
+    [[nodiscard]] MidRegisters registers() const { return m_registers; }
+
     /// @brief Returns a vector containing the original bytes of the target function.
     /// @return A vector of the original bytes of the target function.
     [[nodiscard]] const auto& original_bytes() const { return m_hook.m_original_bytes; }
@@ -879,13 +1107,68 @@ public:
     [[nodiscard]] bool enabled() const { return m_hook.enabled(); }
 
 private:
+    friend class Transaction;
+
     InlineHook m_hook{};
     uint8_t* m_target{};
     Allocation m_stub{};
     MidHookFn m_destination{};
+    MidRegisters m_registers{reg::all};
 
-    std::expected<void, Error> setup(
-        const std::shared_ptr<Allocator>& allocator, uint8_t* target, MidHookFn destination);
+    std::expected<void, Error> setup(const std::shared_ptr<Allocator>& allocator, uint8_t* target,
+        MidHookFn destination, MidRegisters registers = reg::all);
+};
+} // namespace safetyhook
+
+//
+// Header: safetyhook/transaction.hpp
+//
+// Include stack:
+//   - safetyhook.hpp
+//
+
+/// @file safetyhook/transaction.hpp
+/// @brief Enabling several hooks at once.
+
+#pragma once
+
+#ifndef SAFETYHOOK_USE_CXXMODULES
+#include <expected>
+#include <vector>
+#else
+import std.compat;
+#endif
+
+
+namespace safetyhook {
+/// @brief Enables or disables a set of hooks together.
+/// @details Every hook's target and trampoline are trapped once, all jmps (or original bytes) are written, then the
+/// traps are released. Enabling or disabling hooks one by one repeats that cycle per hook.
+/// @note Hooks must be created disabled (StartDisabled) and must outlive the Transaction.
+class Transaction final {
+public:
+    /// @brief Adds a hook to be enabled on commit or disabled on revert.
+    /// @param hook The hook.
+    void add(InlineHook& hook) { m_hooks.push_back(&hook); }
+
+    /// @brief Adds a hook to be enabled on commit or disabled on revert.
+    /// @param hook The hook.
+    void add(MidHook& hook) { m_hooks.push_back(&hook.m_hook); }
+
+    /// @brief Enables every added hook.
+    /// @return Nothing on success. On error the jmps already written are reverted and no added hook is left enabled.
+    /// @note The transaction is empty afterwards, whether it succeeded or not.
+    [[nodiscard]] std::expected<void, InlineHook::Error> commit();
+
+    /// @brief Disables every added hook, restoring their original bytes.
+    /// @note Hooks that aren't enabled are skipped. The transaction is empty afterwards.
+    void revert();
+
+    /// @brief Returns the number of hooks waiting to be committed.
+    [[nodiscard]] size_t size() const { return m_hooks.size(); }
+
+private:
+    std::vector<InlineHook*> m_hooks{};
 };
 } // namespace safetyhook
 
@@ -1123,4 +1406,5 @@ using SafetyHookMid = safetyhook::MidHook;
 using SafetyInlineHook [[deprecated("Use SafetyHookInline instead.")]] = safetyhook::InlineHook;
 using SafetyMidHook [[deprecated("Use SafetyHookMid instead.")]] = safetyhook::MidHook;
 using SafetyHookVmt = safetyhook::VmtHook;
+using SafetyHookTransaction = safetyhook::Transaction;
 using SafetyHookVm = safetyhook::VmHook;
\ No newline at end of file
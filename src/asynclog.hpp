@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/sink.h>
+
+// Asynchronous logging for lines written from game hooks. Producers copy the formatted payload into a
+// bounded lock-free ring and return, a background thread formats and writes the lines to the real sink
+// and flushes once per batch, so no disk I/O happens on the calling thread.
+namespace AsyncLog
+{
+    enum class Overflow
+    {
+        Drop,       // Discard the line and count it, reported by the writer later
+        Block,      // Spin until the writer frees a slot
+    };
+
+    constexpr std::size_t kMaxPayload = 480;
+    constexpr auto kIdleSleep = std::chrono::milliseconds(10);
+
+    struct Entry
+    {
+        spdlog::log_clock::time_point Time;
+        std::size_t ThreadId;
+        spdlog::level::level_enum Level;
+        std::uint16_t Length;
+        char Payload[kMaxPayload];
+    };
+
+    // Bounded MPSC queue (Vyukov style): each slot carries a sequence number, so producers claim a
+    // slot with one CAS on the tail and publish it with one release store.
+    class Ring
+    {
+    public:
+        explicit Ring(std::size_t capacity)
+        {
+            std::size_t size = 2;
+            while (size < capacity)
+                size *= 2;
+            slots = std::make_unique<Slot[]>(size);
+            for (std::size_t i = 0; i < size; ++i)
+                slots[i].Sequence.store(i, std::memory_order_relaxed);
+            mask = size - 1;
+        }
+
+        std::size_t Capacity() const { return mask + 1; }
+
+        bool TryPush(const spdlog::details::log_msg& msg)
+        {
+            std::size_t position = tail.load(std::memory_order_relaxed);
+            for (;;) {
+                Slot& slot = slots[position & mask];
+                std::size_t sequence = slot.Sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+                if (difference == 0) {
+                    if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        Fill(slot.Value, msg);
+                        slot.Sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (difference < 0) {
+                    return false;   // Full
+                }
+                else {
+                    position = tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Single consumer.
+        bool TryPop(Entry& entry)
+        {
+            Slot& slot = slots[head & mask];
+            if (slot.Sequence.load(std::memory_order_acquire) != head + 1)
+                return false;
+
+            entry = slot.Value;
+            slot.Sequence.store(head + mask + 1, std::memory_order_release);
+            head++;
+            return true;
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<std::size_t> Sequence;
+            Entry Value;
+        };
+
+        std::unique_ptr<Slot[]> slots;
+        std::size_t mask = 0;
+        alignas(64) std::atomic<std::size_t> tail{ 0 };
+        alignas(64) std::size_t head = 0;
+
+        static void Fill(Entry& entry, const spdlog::details::log_msg& msg)
+        {
+            entry.Time = msg.time;
+            entry.ThreadId = msg.thread_id;
+            entry.Level = msg.level;
+            entry.Length = static_cast<std::uint16_t>(std::min(msg.payload.size(), kMaxPayload));
+            std::memcpy(entry.Payload, msg.payload.data(), entry.Length);
+        }
+    };
+
+    // Wraps another sink. The writer thread is the only caller of the wrapped sink, so a _st sink is fine.
+    class Sink final : public spdlog::sinks::sink
+    {
+    public:
+        Sink(std::string loggerName, spdlog::sink_ptr target, std::size_t capacity, Overflow overflow)
+            : state(std::make_shared<State>(std::move(loggerName), std::move(target), capacity)), overflow(overflow)
+        {
+            std::thread([state = state] {
+                while (!state->Stopping.load(std::memory_order_acquire)) {
+                    if (!state->Drain())
+                        std::this_thread::sleep_for(kIdleSleep);
+                }
+            }).detach();
+        }
+
+        // Whatever is still queued is written by the destroying thread, the writer thread only
+        // holds the shared state and exits on its next wake.
+        ~Sink() override
+        {
+            state->Stopping.store(true, std::memory_order_release);
+            state->Drain();
+        }
+
+        void log(const spdlog::details::log_msg& msg) override
+        {
+            if (state->Queue.TryPush(msg))
+                return;
+
+            if (overflow == Overflow::Drop) {
+                state->Dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            while (!state->Queue.TryPush(msg))
+                std::this_thread::yield();
+        }
+
+        // Batches are flushed by the writer, there is nothing to do on the caller's thread.
+        void flush() override {}
+
+        void set_pattern(const std::string& pattern) override
+        {
+            std::scoped_lock lock(state->Mutex);
+            state->Target->set_pattern(pattern);
+        }
+
+        void set_formatter(std::unique_ptr<spdlog::formatter> formatter) override
+        {
+            std::scoped_lock lock(state->Mutex);
+            state->Target->set_formatter(std::move(formatter));
+        }
+
+    private:
+        struct State
+        {
+            State(std::string loggerName, spdlog::sink_ptr target, std::size_t capacity)
+                : LoggerName(std::move(loggerName)), Target(std::move(target)), Queue(capacity)
+            {
+            }
+
+            std::string LoggerName;
+            spdlog::sink_ptr Target;
+            Ring Queue;
+            std::mutex Mutex;       // Writer thread vs. the destructor and pattern changes
+            std::atomic<std::uint64_t> Dropped{ 0 };
+            std::atomic<bool> Stopping{ false };
+
+            // Writes everything queued, returns false if there was nothing to write.
+            bool Drain()
+            {
+                std::scoped_lock lock(Mutex);
+                Entry entry;
+                bool wrote = false;
+                while (Queue.TryPop(entry)) {
+                    spdlog::details::log_msg msg(entry.Time, spdlog::source_loc{}, LoggerName, entry.Level, spdlog::string_view_t(entry.Payload, entry.Length));
+                    msg.thread_id = entry.ThreadId;
+                    Target->log(msg);
+                    wrote = true;
+                }
+
+                if (std::uint64_t dropped = Dropped.exchange(0, std::memory_order_relaxed)) {
+                    std::string text = "Logging: Dropped " + std::to_string(dropped) + " line(s), the log queue was full.";
+                    spdlog::details::log_msg msg(LoggerName, spdlog::level::warn, text);
+                    Target->log(msg);
+                    wrote = true;
+                }
+
+                if (wrote)
+                    Target->flush();
+                return wrote;
+            }
+        };
+
+        std::shared_ptr<State> state;
+        Overflow overflow;
+    };
+
+    // Moves the logger's existing sinks behind one async sink each. Call before any hooks are live.
+    inline void Install(spdlog::logger& logger, std::size_t capacity, Overflow overflow)
+    {
+        for (auto& sink : logger.sinks())
+            sink = std::make_shared<Sink>(logger.name(), sink, capacity, overflow);
+    }
+}
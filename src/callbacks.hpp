@@ -0,0 +1,251 @@
+#pragma once
+
+#include "hudrules.hpp"
+#include "published.hpp"
+#include "renderscale.hpp"
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include <safetyhook.hpp>
+
+// Mid hook callbacks that only depend on the hook context, memory it points at and the state below.
+// Nothing here touches Windows, so tools/hookreplay.cpp runs the exact same code outside the game.
+namespace Callbacks
+{
+    // LOD Tweaks values, republished when the ini is reloaded.
+    struct LODSettings
+    {
+        int TerrainDistance = 0;
+        float ModelDistance = 0.00f;
+        float GrassDistance = 0.00f;
+    };
+
+    // Model and grass distances set by the LOD governor, 0 until its first decision. Only the governor
+    // writes these, so they don't go through lodSettings, which the ini reload writes.
+    struct GovernedLOD
+    {
+        std::atomic<float> ModelDistance{ 0.00f };
+        std::atomic<float> GrassDistance{ 0.00f };
+    };
+
+    // Filled in by the fixes before the hooks go live.
+    inline RenderScale::Published renderScale;
+    inline Util::Published<LODSettings> lodSettings;
+    inline GovernedLOD governedLOD;
+    inline std::atomic<bool> bIsMoviePlaying;
+    inline HUDRules::Table HUDBackgroundsTable;
+    inline HUDRules::Layout HUDBackgroundsLayout;
+
+    enum class Id : std::uint16_t
+    {
+        ThrowableMarker,
+        LensEffects,
+        DepthOfField,
+        HUDBackgrounds,
+        Markers,
+        MarkerConstraint,
+        Overlay,
+        SonarMarkers,
+        MovieFrame,
+        MovieStatus,
+        MovieViewport,
+        LODFactorResolution,
+        ModelQuality,
+        Count,
+    };
+
+    inline constexpr const char* kNames[] = {
+        "ThrowableMarker", "LensEffects", "DepthOfField", "HUDBackgrounds", "Markers", "MarkerConstraint", "Overlay",
+        "SonarMarkers", "MovieFrame", "MovieStatus", "MovieViewport", "LODFactorResolution", "ModelQuality",
+    };
+    static_assert(std::size(kNames) == static_cast<std::size_t>(Id::Count));
+
+    inline void ThrowableMarker(SafetyHookContext& ctx)
+    {
+        const auto& scale = renderScale.Load();
+        if (scale.Wider)
+            ctx.xmm7.f32[0] = scale.AspectMultiplier;
+    }
+
+    inline void LensEffects(SafetyHookContext& ctx)
+    {
+        const auto& scale = renderScale.Load();
+        if (scale.Wider) {
+            ctx.xmm13.f32[0] = RenderScale::kNativeAspect;
+            ctx.xmm9.f32[0] *= scale.InverseAspectMultiplier;
+        }
+    }
+
+    inline void DepthOfField(SafetyHookContext& ctx)
+    {
+        const auto& scale = renderScale.Load();
+        if (scale.Wider) {
+            ctx.xmm6.f32[0] = scale.DepthOfFieldScale;
+            ctx.xmm4.f32[0] = scale.HUDWidth;
+        }
+    }
+
+    inline void HUDBackgrounds(SafetyHookContext& ctx)
+    {
+        if (!ctx.rcx)
+            return;
+
+        float Width = *reinterpret_cast<float*>(ctx.rcx + HUDBackgroundsLayout.WidthOffset);
+        float Height = *reinterpret_cast<float*>(ctx.rcx + HUDBackgroundsLayout.HeightOffset);
+
+        const auto& scale = renderScale.Load();
+
+        // Resize HUD to counteract viewport scaling when a movie plays
+        if (bIsMoviePlaying.load(std::memory_order_relaxed)) {
+            if (scale.Wider && Width > 1.00f) {
+                ctx.xmm0.f32[0] *= scale.AspectMultiplier;
+            }
+        }
+
+        const HUDRules::Rule* rule = HUDBackgroundsTable.Find(Width, Height);
+        if (!rule)
+            return;
+
+        switch (rule->Do) {
+        case HUDRules::Action::Span:
+            if (scale.Wider)
+                ctx.xmm0.f32[0] *= scale.AspectMultiplier;
+            break;
+        case HUDRules::Action::ScopeScale:
+            // Set the overall width scale, or reset it in-case the resolution has changed.
+            *reinterpret_cast<float*>(ctx.rcx + HUDBackgroundsLayout.ScaleOffset) = scale.ScopeScale;
+            break;
+        }
+    }
+
+    inline void Markers(SafetyHookContext& ctx)
+    {
+        *reinterpret_cast<float*>(ctx.rdx + 0x120) = renderScale.Load().MarkerSize;
+        ctx.xmm1.f32[0] = 64.00f;
+    }
+
+    // Left and right constraint hooks do the same thing.
+    inline void MarkerConstraint(SafetyHookContext& ctx)
+    {
+        const auto& scale = renderScale.Load();
+        if (scale.Wider)
+            ctx.xmm0.f32[0] *= scale.AspectMultiplier;
+    }
+
+    // All three overlay hooks do the same thing.
+    inline void Overlay(SafetyHookContext& ctx)
+    {
+        const auto& scale = renderScale.Load();
+        if (scale.Wider)
+            ctx.xmm5.f32[0] *= scale.AspectMultiplier;
+    }
+
+    inline void SonarMarkers(SafetyHookContext& ctx)
+    {
+        const auto& scale = renderScale.Load();
+        if (scale.Wider)
+            ctx.xmm0.f32[0] *= scale.AspectMultiplier;
+    }
+
+    inline void MovieFrame(SafetyHookContext& ctx)
+    {
+        if (renderScale.Load().Wider)
+            ctx.rflags |= (1ULL << 0); // Set CF
+    }
+
+    inline void MovieStatus(SafetyHookContext& ctx)
+    {
+        // Playing/paused
+        bIsMoviePlaying.store(ctx.rax == 1 || ctx.rax == 2, std::memory_order_relaxed);
+    }
+
+    inline void MovieViewport(SafetyHookContext& ctx)
+    {
+        if (bIsMoviePlaying.load(std::memory_order_relaxed)) {
+            const auto& scale = renderScale.Load();
+            if (scale.Wider)
+                ctx.xmm1.f32[0] = scale.HUDWidth;
+        }
+    }
+
+    inline void LODFactorResolution(SafetyHookContext& ctx)
+    {
+        ctx.xmm3.u16[0] = static_cast<std::uint16_t>(lodSettings.Load().TerrainDistance);
+    }
+
+    inline void ModelQuality(SafetyHookContext& ctx)
+    {
+        const auto& lod = lodSettings.Load();
+        if (ctx.rbx == 9) {
+            float governed = governedLOD.GrassDistance.load(std::memory_order_relaxed);
+            ctx.rax = std::bit_cast<std::uint32_t>(governed > 0.00f ? governed : lod.GrassDistance);
+        }
+        else {
+            float governed = governedLOD.ModelDistance.load(std::memory_order_relaxed);
+            ctx.rax = std::bit_cast<std::uint32_t>(governed > 0.00f ? governed : lod.ModelDistance);
+        }
+    }
+
+    inline void Run(Id id, SafetyHookContext& ctx)
+    {
+        switch (id) {
+        case Id::ThrowableMarker:       ThrowableMarker(ctx); break;
+        case Id::LensEffects:           LensEffects(ctx); break;
+        case Id::DepthOfField:          DepthOfField(ctx); break;
+        case Id::HUDBackgrounds:        HUDBackgrounds(ctx); break;
+        case Id::Markers:               Markers(ctx); break;
+        case Id::MarkerConstraint:      MarkerConstraint(ctx); break;
+        case Id::Overlay:               Overlay(ctx); break;
+        case Id::SonarMarkers:          SonarMarkers(ctx); break;
+        case Id::MovieFrame:            MovieFrame(ctx); break;
+        case Id::MovieStatus:           MovieStatus(ctx); break;
+        case Id::MovieViewport:         MovieViewport(ctx); break;
+        case Id::LODFactorResolution:   LODFactorResolution(ctx); break;
+        case Id::ModelQuality:          ModelQuality(ctx); break;
+        case Id::Count:                 break;
+        }
+    }
+
+    // Memory a callback reads or writes, as an offset from one of the context's registers.
+    struct Span
+    {
+        std::uint16_t Register;     // Byte offset of the register in SafetyHookContext
+        std::int32_t Offset;
+        std::uint8_t Size;
+    };
+
+    constexpr std::size_t kMaxSpans = 3;
+
+    // Fills spans with what the callback will touch given the current state, returns how many.
+    inline std::size_t Spans(Id id, const SafetyHookContext& ctx, Span (&spans)[kMaxSpans])
+    {
+        constexpr auto rcx = static_cast<std::uint16_t>(offsetof(SafetyHookContext, rcx));
+        constexpr auto rdx = static_cast<std::uint16_t>(offsetof(SafetyHookContext, rdx));
+        switch (id) {
+        case Id::HUDBackgrounds: {
+            if (!ctx.rcx)
+                return 0;
+            spans[0] = { rcx, static_cast<std::int32_t>(HUDBackgroundsLayout.WidthOffset), 4 };
+            spans[1] = { rcx, static_cast<std::int32_t>(HUDBackgroundsLayout.HeightOffset), 4 };
+
+            // The scale is only touched on elements that have it.
+            float Width = *reinterpret_cast<const float*>(ctx.rcx + HUDBackgroundsLayout.WidthOffset);
+            float Height = *reinterpret_cast<const float*>(ctx.rcx + HUDBackgroundsLayout.HeightOffset);
+            const HUDRules::Rule* rule = HUDBackgroundsTable.Find(Width, Height);
+            if (!rule || rule->Do != HUDRules::Action::ScopeScale)
+                return 2;
+            spans[2] = { rcx, static_cast<std::int32_t>(HUDBackgroundsLayout.ScaleOffset), 4 };
+            return 3;
+        }
+        case Id::Markers:
+            spans[0] = { rdx, 0x120, 4 };
+            return 1;
+        default:
+            return 0;
+        }
+    }
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "renderscale.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <expected>
+#include <mutex>
+#include <vector>
+
+#include <safetyhook.hpp>
+
+// Native stand-ins for mid hooks that only multiply an xmm register by a render scale value. The
+// target jumps to a cave that runs mulss xmmN, [rip+factor] and then jumps to the hook's trampoline,
+// where safetyhook has relocated the displaced instructions, and from there back. No context is saved
+// and nothing is called.
+// Each cave keeps its own factor, rewritten whenever the render scale is republished. Caves get 1.0,
+// which leaves the register as it was, until a resolution is known and, if wider-only, when the
+// screen isn't wider than 16:9.
+namespace CodeCave
+{
+    class Scale;
+
+    namespace Detail
+    {
+        inline std::mutex mutex;
+        inline std::vector<Scale*> caves;
+        inline RenderScale::Snapshot current;
+    }
+
+    class Scale
+    {
+    public:
+        Scale() = default;
+        Scale(const Scale&) = delete;
+        Scale& operator=(const Scale&) = delete;
+        ~Scale() { Reset(); }
+
+        // Hooks target, disabled until the hook is enabled (e.g. by a transaction). The Scale must stay
+        // where it is until Reset().
+        std::expected<void, safetyhook::MidHook::Error> Create(const std::shared_ptr<safetyhook::Allocator>& allocator, std::uint8_t* target, std::uint8_t xmm,
+                                                               float RenderScale::Snapshot::* value, bool widerOnly = true)
+        {
+            Reset();
+
+            auto allocation = allocator->allocate(kSize);
+            if (!allocation)
+                return std::unexpected(safetyhook::MidHook::Error::bad_allocation(allocation.error()));
+            cave = std::move(*allocation);
+
+            // mulss xmmN, [rip+factor] ; jmp [rip+trampoline]
+            std::uint8_t* code = cave.data();
+            std::size_t size = 0;
+            code[size++] = 0xF3;
+            if (xmm >= 8)
+                code[size++] = 0x44;
+            code[size++] = 0x0F;
+            code[size++] = 0x59;
+            code[size++] = static_cast<std::uint8_t>(0x05 | ((xmm & 7) << 3));
+            safetyhook::store(code + size, static_cast<std::int32_t>(kFactor - (size + 4)));
+            size += 4;
+            code[size++] = 0xFF;
+            code[size++] = 0x25;
+            safetyhook::store(code + size, static_cast<std::int32_t>(kTrampoline - (size + 4)));
+
+            auto result = safetyhook::InlineHook::create(allocator, target, cave.data(), safetyhook::InlineHook::StartDisabled);
+            if (!result) {
+                cave.free();
+                return std::unexpected(safetyhook::MidHook::Error::bad_inline_hook(result.error()));
+            }
+            // The cave has to be complete before the hook is visible to anything that might enable it.
+            safetyhook::store(code + kTrampoline, result->trampoline().data());
+            hook = std::move(*result);
+
+            this->value = value;
+            this->widerOnly = widerOnly;
+            std::scoped_lock lock(Detail::mutex);
+            Refresh(Detail::current);
+            Detail::caves.push_back(this);
+            return {};
+        }
+
+        // Unhooks and frees the cave.
+        void Reset()
+        {
+            if (!cave)
+                return;
+            {
+                std::scoped_lock lock(Detail::mutex);
+                std::erase(Detail::caves, this);
+            }
+            hook = {};
+            cave.free();
+        }
+
+        safetyhook::InlineHook& Hook() { return hook; }
+        const safetyhook::Allocation& Cave() const { return cave; }
+
+        // Called with Detail::mutex held.
+        void Refresh(const RenderScale::Snapshot& scale)
+        {
+            float factor = (!scale.ResX || (widerOnly && !scale.Wider)) ? 1.00f : scale.*value;
+            std::atomic_ref(*reinterpret_cast<float*>(cave.data() + kFactor)).store(factor, std::memory_order_relaxed);
+        }
+
+    private:
+        static constexpr std::size_t kTrampoline = 16;
+        static constexpr std::size_t kFactor = 24;
+        static constexpr std::size_t kSize = 32;
+
+        safetyhook::Allocation cave;
+        safetyhook::InlineHook hook;
+        float RenderScale::Snapshot::* value = nullptr;
+        bool widerOnly = true;
+    };
+
+    // Call after publishing a new render scale.
+    inline void Refresh(const RenderScale::Snapshot& scale)
+    {
+        std::scoped_lock lock(Detail::mutex);
+        Detail::current = scale;
+        for (Scale* cave : Detail::caves)
+            cave->Refresh(scale);
+    }
+}
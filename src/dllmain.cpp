@@ -1,5 +1,19 @@
 ﻿#include "stdafx.h"
 #include "helper.hpp"
+#include "signatures.hpp"
+#include "sigcache.hpp"
+#include "hooks.hpp"
+#include "hudrules.hpp"
+#include "renderscale.hpp"
+#include "asynclog.hpp"
+#include "framelimiter.hpp"
+#include "startup.hpp"
+#include "callbacks.hpp"
+#include "hookcapture.hpp"
+#include "manifest.hpp"
+#include "lodgovernor.hpp"
+#include "timerresolution.hpp"
+#include "threadregistry.hpp"
 
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/basic_file_sink.h>
@@ -10,6 +24,7 @@
 
 HMODULE exeModule = GetModuleHandle(NULL);
 HMODULE thisModule;
+Startup::Clock::time_point loadTime;
 
 // Fix details
 std::string sFixName = "MGSVFix";
@@ -20,6 +35,12 @@ std::filesystem::path sFixPath;
 inipp::Ini<char> ini;
 std::string sConfigFile = sFixName + ".ini";
 
+// Signature cache
+std::string sSigCacheFile = sFixName + ".sigcache";
+
+// Patch manifest
+std::string sManifestFile = sFixName + ".patches";
+
 // Logger
 std::shared_ptr<spdlog::logger> logger;
 std::string sLogFile = sFixName + ".log";
@@ -29,16 +50,18 @@ std::string sExeName;
 // Aspect ratio / FOV / HUD
 std::pair DesktopDimensions = { 0,0 };
 const float fPi = 3.1415926535f;
-const float fNativeAspect = 16.00f / 9.00f;
-float fAspectRatio;
-float fAspectMultiplier;
-float fHUDWidth;
-float fHUDWidthOffset;
-float fHUDHeight;
-float fHUDHeightOffset;
+const float fNativeAspect = RenderScale::kNativeAspect;
+using Callbacks::renderScale;
 
 // Ini variables
+bool bAsyncLogging;
+std::string sLogOverflow = "Drop";
+int iLogQueueSize = 4096;
 bool bUnlockFPS;
+int iMaxFPS;
+float fTimerResolution = 0.50f;
+bool bFrameTelemetry;
+int iTelemetryInterval = 10;
 bool bFixResolution;
 bool bFixAspect;
 bool bFixHUD;
@@ -46,11 +69,33 @@ bool bLODTweaks;
 int iTerrainDistance;
 float fModelDistance;
 float fGrassDistance;
+bool bLODGovernor;
+float fGovernorTargetFrameTime = 16.67f;
+int iGovernorHysteresis = 10;
+float fGovernorMinModelDistance = 128.00f;
+float fGovernorMinGrassDistance = 250.00f;
+bool bLiveReload;
+bool bHookCapture;
+int iHookCaptureRecords = 1000;
+bool bThreadPolicy;
+std::string sUltrawideHooks = "Auto";
+std::vector<Topology::Rule> ThreadRules;
+std::vector<HUDRules::Rule> HUDBackgroundRules(std::begin(HUDRules::kDefaultRules), std::end(HUDRules::kDefaultRules));
 
 // Variables
 int iCurrentResX;
 int iCurrentResY;
-bool bIsMoviePlaying;
+using Callbacks::bIsMoviePlaying;
+std::uint8_t* TPPLODFactorResolution = nullptr;
+std::atomic<LODGovernor::Controller*> lodGovernor{ nullptr };
+LODGovernor::DecisionQueue lodDecisions;
+FrameLimiter::Pacer framePacer;
+TimerResolution::Manager timerResolution;
+bool bTimerResolutionRaised;
+using Callbacks::HUDBackgroundsTable;
+using Callbacks::HUDBackgroundsLayout;
+HookCapture::Writer hookCapture;
+ThreadRegistry::Registry threadRegistry;
 
 // Game info
 struct GameInfo
@@ -59,13 +104,6 @@ struct GameInfo
     std::string ExeName;
 };
 
-enum class Game 
-{
-    Unknown,
-    TPP,      // MGS V: The Phantom Pain
-    GZ,       // MGS V: Ground Zeroes
-};
-
 const std::map<Game, GameInfo> kGames = {
     {Game::GZ, {"METAL GEAR SOLID V: GROUND ZEROES", "MgsGroundZeroes.exe"}},
     {Game::TPP, {"METAL GEAR SOLID V: THE PHANTOM PAIN", "mgsvtpp.exe"}},
@@ -74,41 +112,94 @@ const std::map<Game, GameInfo> kGames = {
 const GameInfo* game = nullptr;
 Game eGameType = Game::Unknown;
 
+// Module index, built while the ini is parsed
+std::vector<Scanner::Region> ModuleRegions;
+std::optional<SigCache::Cache> SignatureCache;
+
+// Patches loaded from the manifest, scanned together with the built-in signatures
+std::deque<Manifest::Patch> ManifestPatches;
+
+// Signature scan results
+std::map<const Signatures::Signature*, std::vector<std::uint8_t*>> SignatureResults;
+
+// How often each hook runs, for its place in the hook arena. Unlisted hooks (manifest patches too) are cold.
+constexpr Hooks::HeatRule kHookHeat[] = {
+    {"HUDBackgrounds", Hooks::Heat::Hot},
+    {"Markers", Hooks::Heat::Hot},
+    {"MarkerConstraintRight", Hooks::Heat::Hot},
+    {"MarkerConstraintLeft", Hooks::Heat::Hot},
+    {"Overlay1", Hooks::Heat::Hot},
+    {"Overlay2", Hooks::Heat::Hot},
+    {"Overlay3", Hooks::Heat::Hot},
+    {"SonarMarkers", Hooks::Heat::Hot},
+    {"ThrowableMarker", Hooks::Heat::Warm},
+    {"LensEffects", Hooks::Heat::Warm},
+    {"DepthOfField", Hooks::Heat::Warm},
+    {"ThreadSleep", Hooks::Heat::Warm},
+    {"LODFactorResolution", Hooks::Heat::Warm},
+    {"ModelQuality", Hooks::Heat::Warm},
+};
+
+// Hooks created by the fixes, enabled together once all fixes have run
+Hooks::Transaction hookTransaction(kHookHeat);
+
+// Hooks that only change anything wider than 16:9, switched off at 16:9 or narrower by UpdateHookGroups()
+// on the hook group switcher's thread
+Hooks::Group aspectHooks("Aspect");
+Hooks::Group hudHooks("HUD");
+Hooks::Group movieHooks("Movies");
+Hooks::Group manifestHooks("Manifest");
+Hooks::Group* const kUltrawideGroups[] = { &aspectHooks, &hudHooks, &movieHooks, &manifestHooks };
+std::atomic<Hooks::Mode> ultrawideHooks{ Hooks::Mode::Auto };
+
 void CalculateAspectRatio(bool bLog)
 {
     if (iCurrentResX <= 0 || iCurrentResY <= 0)
         return;
 
-    // Calculate aspect ratio
-    fAspectRatio = (float)iCurrentResX / (float)iCurrentResY;
-    fAspectMultiplier = fAspectRatio / fNativeAspect;
-
-    // HUD 
-    fHUDWidth = (float)iCurrentResY * fNativeAspect;
-    fHUDHeight = (float)iCurrentResY;
-    fHUDWidthOffset = (float)(iCurrentResX - fHUDWidth) / 2.00f;
-    fHUDHeightOffset = 0.00f;
-    if (fAspectRatio < fNativeAspect) {
-        fHUDWidth = (float)iCurrentResX;
-        fHUDHeight = (float)iCurrentResX / fNativeAspect;
-        fHUDWidthOffset = 0.00f;
-        fHUDHeightOffset = (float)(iCurrentResY - fHUDHeight) / 2.00f;
-    }
+    // Publish everything the hooks need in one snapshot
+    const auto scale = RenderScale::Compute(iCurrentResX, iCurrentResY);
+    renderScale.Store(scale);
+    CodeCave::Refresh(scale);
 
     // Log details about current resolution
     if (bLog) {
         spdlog::info("----------");
-        spdlog::info("Current Resolution: Resolution: {:d}x{:d}", iCurrentResX, iCurrentResY);
-        spdlog::info("Current Resolution: fAspectRatio: {}", fAspectRatio);
-        spdlog::info("Current Resolution: fAspectMultiplier: {}", fAspectMultiplier);
-        spdlog::info("Current Resolution: fHUDWidth: {}", fHUDWidth);
-        spdlog::info("Current Resolution: fHUDHeight: {}", fHUDHeight);
-        spdlog::info("Current Resolution: fHUDWidthOffset: {}", fHUDWidthOffset);
-        spdlog::info("Current Resolution: fHUDHeightOffset: {}", fHUDHeightOffset);
+        spdlog::info("Current Resolution: Resolution: {:d}x{:d}", scale.ResX, scale.ResY);
+        spdlog::info("Current Resolution: fAspectRatio: {}", scale.AspectRatio);
+        spdlog::info("Current Resolution: fAspectMultiplier: {}", scale.AspectMultiplier);
+        spdlog::info("Current Resolution: fHUDWidth: {}", scale.HUDWidth);
+        spdlog::info("Current Resolution: fHUDHeight: {}", scale.HUDHeight);
+        spdlog::info("Current Resolution: fHUDWidthOffset: {}", scale.HUDWidthOffset);
+        spdlog::info("Current Resolution: fHUDHeightOffset: {}", scale.HUDHeightOffset);
         spdlog::info("----------");
     }
 }
 
+Hooks::Mode ParseHookMode(const std::string& mode)
+{
+    if (Util::string_cmp_caseless(mode, "On"))
+        return Hooks::Mode::On;
+    if (Util::string_cmp_caseless(mode, "Off"))
+        return Hooks::Mode::Off;
+    if (!Util::string_cmp_caseless(mode, "Auto"))
+        spdlog::error("Config Parse: Ultrawide Hooks: Unknown Mode \"{:s}\", using Auto.", mode);
+    return Hooks::Mode::Auto;
+}
+
+// Runs on the switcher's thread only, request it with hookGroupSwitcher.Request()
+void UpdateHookGroups()
+{
+    // Until a resolution is known the hooks stay on, in case it never is
+    const auto& scale = renderScale.Load();
+    auto mode = ultrawideHooks.load(std::memory_order_relaxed);
+    bool enable = mode == Hooks::Mode::On || (mode == Hooks::Mode::Auto && (!scale.ResX || scale.Wider));
+    for (auto* group : kUltrawideGroups)
+        group->Set(enable);
+}
+
+Hooks::Switcher hookGroupSwitcher(UpdateHookGroups);
+
 void Logging()
 {
     // Get path to DLL
@@ -127,7 +218,8 @@ void Logging()
     // Spdlog initialisation
     try
     {
-        logger = spdlog::basic_logger_st(sFixName, sExePath.string() + sLogFile, true);
+        // Startup stages log from several threads at once
+        logger = spdlog::basic_logger_mt(sFixName, sExePath.string() + sLogFile, true);
         spdlog::set_default_logger(logger);
         spdlog::flush_on(spdlog::level::debug);
 
@@ -140,6 +232,7 @@ void Logging()
         spdlog::info("Module Path: {:s}", sExePath.string());
         spdlog::info("Module Address: 0x{:x}", (uintptr_t)exeModule);
         spdlog::info("Module Timestamp: {:d}", Memory::ModuleTimestamp(exeModule));
+        spdlog::info("Pattern Scanner: {:s}", Scanner::IsaName(Scanner::ActiveIsa()));
         spdlog::info("----------");
     }
     catch (const spdlog::spdlog_ex &ex)
@@ -152,7 +245,7 @@ void Logging()
     }
 }
 
-void Configuration()
+bool Configuration()
 {
     // Inipp initialisation
     std::ifstream iniFile(sFixPath / sConfigFile);
@@ -165,8 +258,7 @@ void Configuration()
         std::cout << "ERROR: Could not locate config file." << std::endl;
         std::cout << "ERROR: Make sure " << sConfigFile.c_str() << " is located in " << sFixPath.string().c_str() << std::endl;
         spdlog::error("ERROR: Could not locate config file {}", sConfigFile);
-        spdlog::shutdown();
-        FreeLibraryAndExitThread(thisModule, 1);
+        return false;
     }
     else
     {
@@ -179,7 +271,15 @@ void Configuration()
     spdlog::info("----------");
 
     // Load settings from ini
+    inipp::get_value(ini.sections["Live Reload"], "Enabled", bLiveReload);
+    inipp::get_value(ini.sections["Logging"], "Async", bAsyncLogging);
+    inipp::get_value(ini.sections["Logging"], "Overflow", sLogOverflow);
+    inipp::get_value(ini.sections["Logging"], "QueueSize", iLogQueueSize);
     inipp::get_value(ini.sections["Unlock Framerate"], "Enabled", bUnlockFPS);
+    inipp::get_value(ini.sections["Unlock Framerate"], "MaxFPS", iMaxFPS);
+    inipp::get_value(ini.sections["Unlock Framerate"], "TimerResolution", fTimerResolution);
+    inipp::get_value(ini.sections["Frame Telemetry"], "Enabled", bFrameTelemetry);
+    inipp::get_value(ini.sections["Frame Telemetry"], "Interval", iTelemetryInterval);
     inipp::get_value(ini.sections["Fix Resolution"], "Enabled", bFixResolution);
     inipp::get_value(ini.sections["Fix Aspect"], "Enabled", bFixAspect);
     inipp::get_value(ini.sections["Fix HUD"], "Enabled", bFixHUD);
@@ -187,9 +287,42 @@ void Configuration()
     inipp::get_value(ini.sections["LOD Tweaks"], "TerrainDistance", iTerrainDistance);
     inipp::get_value(ini.sections["LOD Tweaks"], "ModelDistance", fModelDistance);
     inipp::get_value(ini.sections["LOD Tweaks"], "GrassDistance", fGrassDistance);
+    inipp::get_value(ini.sections["LOD Governor"], "Enabled", bLODGovernor);
+    inipp::get_value(ini.sections["LOD Governor"], "TargetFrameTime", fGovernorTargetFrameTime);
+    inipp::get_value(ini.sections["LOD Governor"], "Hysteresis", iGovernorHysteresis);
+    inipp::get_value(ini.sections["LOD Governor"], "MinModelDistance", fGovernorMinModelDistance);
+    inipp::get_value(ini.sections["LOD Governor"], "MinGrassDistance", fGovernorMinGrassDistance);
+    inipp::get_value(ini.sections["Hook Capture"], "Enabled", bHookCapture);
+    inipp::get_value(ini.sections["Hook Capture"], "MaxRecords", iHookCaptureRecords);
+    inipp::get_value(ini.sections["Thread Policy"], "Enabled", bThreadPolicy);
+    inipp::get_value(ini.sections["Ultrawide Hooks"], "Mode", sUltrawideHooks);
+
+    // Extra HUD background rules, named by their ini key
+    for (const auto& [name, value] : ini.sections["HUD Background Rules"]) {
+        if (auto rule = HUDRules::ParseRule(name, value))
+            HUDBackgroundRules.push_back(*rule);
+        else
+            spdlog::error("Config Parse: HUD Background Rules: Ignoring invalid rule \"{:s} = {:s}\".", name, value);
+    }
+
+    // Thread placement rules, keyed by thread name
+    for (const auto& [name, value] : ini.sections["Thread Policy Rules"]) {
+        if (auto rule = Topology::ParseRule(name, value))
+            ThreadRules.push_back(*rule);
+        else
+            spdlog::error("Config Parse: Thread Policy Rules: Ignoring invalid rule \"{:s} = {:s}\".", name, value);
+    }
 
     // Log ini parse
+    spdlog_confparse(bLiveReload);
+    spdlog_confparse(bAsyncLogging);
+    spdlog_confparse(sLogOverflow);
+    spdlog_confparse(iLogQueueSize);
     spdlog_confparse(bUnlockFPS);
+    spdlog_confparse(iMaxFPS);
+    spdlog_confparse(fTimerResolution);
+    spdlog_confparse(bFrameTelemetry);
+    spdlog_confparse(iTelemetryInterval);
     spdlog_confparse(bFixResolution);
     spdlog_confparse(bFixAspect);
     spdlog_confparse(bFixHUD);
@@ -197,8 +330,181 @@ void Configuration()
     spdlog_confparse(iTerrainDistance);
     spdlog_confparse(fModelDistance);
     spdlog_confparse(fGrassDistance);
+    spdlog_confparse(bLODGovernor);
+    spdlog_confparse(fGovernorTargetFrameTime);
+    spdlog_confparse(iGovernorHysteresis);
+    spdlog_confparse(fGovernorMinModelDistance);
+    spdlog_confparse(fGovernorMinGrassDistance);
+    spdlog_confparse(bHookCapture);
+    spdlog_confparse(iHookCaptureRecords);
+    spdlog_confparse(bThreadPolicy);
+    spdlog_confparse(sUltrawideHooks);
+    spdlog::info("Config Parse: HUD Background Rules: {:d} ({:d} from ini)", HUDBackgroundRules.size(), HUDBackgroundRules.size() - std::size(HUDRules::kDefaultRules));
+    spdlog::info("Config Parse: Thread Policy Rules: {:d}", ThreadRules.size());
+
+    Callbacks::lodSettings.Store({ iTerrainDistance, fModelDistance, fGrassDistance });
+    ultrawideHooks.store(ParseHookMode(sUltrawideHooks), std::memory_order_relaxed);
 
     spdlog::info("----------");
+    return true;
+}
+
+// Ini keys that take effect without a restart, while the setting they need (if any) is enabled
+struct LiveKey
+{
+    std::string_view Section;
+    std::string_view Key;
+    const bool* Needs;
+};
+
+const LiveKey kLiveKeys[] = {
+    { "LOD Tweaks", "TerrainDistance", &bLODTweaks },
+    { "LOD Tweaks", "ModelDistance", &bLODTweaks },
+    { "LOD Tweaks", "GrassDistance", &bLODTweaks },
+    { "Ultrawide Hooks", "Mode", nullptr },
+};
+
+void ReloadConfiguration()
+{
+    std::ifstream iniFile(sFixPath / sConfigFile);
+    if (!iniFile) {
+        spdlog::error("Config Reload: Could not open {:s}.", sConfigFile);
+        return;
+    }
+    inipp::Ini<char> reloaded;
+    reloaded.parse(iniFile);
+    reloaded.strip_trailing_comments();
+
+    // Log every key that changed
+    auto lookup = [](const inipp::Ini<char>& from, const std::string& section, const std::string& key) -> std::string {
+        auto foundSection = from.sections.find(section);
+        if (foundSection == from.sections.end())
+            return {};
+        auto foundKey = foundSection->second.find(key);
+        return foundKey == foundSection->second.end() ? std::string{} : foundKey->second;
+    };
+    std::set<std::pair<std::string, std::string>> keys;
+    for (const auto* from : { &ini, &reloaded }) {
+        for (const auto& [section, values] : from->sections) {
+            for (const auto& [key, value] : values)
+                keys.emplace(section, key);
+        }
+    }
+
+    std::size_t changed = 0;
+    for (const auto& [section, key] : keys) {
+        std::string before = lookup(ini, section, key);
+        std::string after = lookup(reloaded, section, key);
+        if (before == after)
+            continue;
+        changed++;
+
+        bool live = std::any_of(std::begin(kLiveKeys), std::end(kLiveKeys), [&](const auto& liveKey) {
+            return liveKey.Section == section && liveKey.Key == key && (!liveKey.Needs || *liveKey.Needs);
+        });
+        spdlog::info("Config Reload: [{:s}] {:s}: \"{:s}\" -> \"{:s}\"{:s}", section, key, before, after, live ? "" : " (needs a restart)");
+    }
+    ini = std::move(reloaded);
+    if (!changed) {
+        spdlog::info("Config Reload: No changes.");
+        return;
+    }
+
+    if (bLODTweaks) {
+        // Hooks pick up the new snapshot on their next call, absolute writes are redone here
+        inipp::get_value(ini.sections["LOD Tweaks"], "TerrainDistance", iTerrainDistance);
+        auto lod = Callbacks::lodSettings.Load();
+        lod.TerrainDistance = iTerrainDistance;
+        if (lodGovernor.load(std::memory_order_acquire)) {
+            spdlog::info("Config Reload: LOD Governor controls model/grass distances, their maximums change after a restart.");
+        }
+        else {
+            inipp::get_value(ini.sections["LOD Tweaks"], "ModelDistance", fModelDistance);
+            inipp::get_value(ini.sections["LOD Tweaks"], "GrassDistance", fGrassDistance);
+            lod.ModelDistance = fModelDistance;
+            lod.GrassDistance = fGrassDistance;
+        }
+        Callbacks::lodSettings.Store(lod);
+
+        if (TPPLODFactorResolution)
+            Memory::Write(TPPLODFactorResolution, iTerrainDistance);
+    }
+
+    inipp::get_value(ini.sections["Ultrawide Hooks"], "Mode", sUltrawideHooks);
+    ultrawideHooks.store(ParseHookMode(sUltrawideHooks), std::memory_order_relaxed);
+    hookGroupSwitcher.Request();
+}
+
+void ConfigWatcher()
+{
+    if (!bLiveReload)
+        return;
+
+    HANDLE change = FindFirstChangeNotificationW(sFixPath.wstring().c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE);
+    if (change == INVALID_HANDLE_VALUE) {
+        spdlog::error("Config Reload: Failed to watch {:s} for changes.", sFixPath.string());
+        return;
+    }
+    spdlog::info("Config Reload: Watching {:s} for changes.", sConfigFile);
+
+    std::thread([change] {
+        // Any file in the folder wakes us, only reload when the ini itself was written
+        std::error_code error;
+        auto lastWrite = std::filesystem::last_write_time(sFixPath / sConfigFile, error);
+        while (WaitForSingleObject(change, INFINITE) == WAIT_OBJECT_0) {
+            // Give the editor time to finish saving
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+            auto write = std::filesystem::last_write_time(sFixPath / sConfigFile, error);
+            if (!error && write != lastWrite) {
+                lastWrite = write;
+                ReloadConfiguration();
+            }
+            if (!FindNextChangeNotification(change))
+                break;
+        }
+        FindCloseChangeNotification(change);
+    }).detach();
+}
+
+void AsyncLogging()
+{
+    // Swaps the logger's sinks, the startup graph keeps every other stage from logging meanwhile
+    if (bAsyncLogging) {
+        iLogQueueSize = std::clamp(iLogQueueSize, 64, 65536);
+        auto overflow = AsyncLog::Overflow::Drop;
+        if (Util::string_cmp_caseless(sLogOverflow, "Block"))
+            overflow = AsyncLog::Overflow::Block;
+        else if (!Util::string_cmp_caseless(sLogOverflow, "Drop"))
+            spdlog::error("Config Parse: Logging: Unknown Overflow \"{:s}\", using Drop.", sLogOverflow);
+
+        AsyncLog::Install(*logger, static_cast<std::size_t>(iLogQueueSize), overflow);
+        spdlog::info("Logging: Asynchronous, {:d} line queue, {:s} when full.", iLogQueueSize, overflow == AsyncLog::Overflow::Block ? "block" : "drop");
+    }
+}
+
+void LoadPatchManifest()
+{
+    // The manifest is optional
+    std::ifstream manifestFile(sFixPath / sManifestFile);
+    if (!manifestFile)
+        return;
+
+    inipp::Ini<char> manifest;
+    manifest.parse(manifestFile);
+    manifest.strip_trailing_comments();
+
+    for (const auto& [name, keys] : manifest.sections) {
+        if (name.empty())
+            continue;
+
+        auto& patch = ManifestPatches.emplace_back();
+        std::string error;
+        if (!Manifest::Parse(patch, name, keys, error)) {
+            spdlog::error("Patch Manifest: Ignoring invalid patch \"{:s}\": {:s}", name, error);
+            ManifestPatches.pop_back();
+        }
+    }
+    spdlog::info("Patch Manifest: Loaded {:d} patches from {:s}.", ManifestPatches.size(), (sFixPath / sManifestFile).string());
 }
 
 bool DetectGame()
@@ -218,15 +524,106 @@ bool DetectGame()
     return false;
 }
 
+void IndexModule()
+{
+    // Only executable sections can hold the code we patch.
+    ModuleRegions = Memory::ScanRegions(exeModule);
+
+    // Cached hits for this exe build only need to be re-matched at their old address.
+    SignatureCache.emplace(sFixPath / sSigCacheFile, sExeName, Memory::ModuleTimestamp(exeModule));
+    SignatureCache->Load();
+}
+
+void ScanSignatures()
+{
+    const auto& regions = ModuleRegions;
+    auto& cache = *SignatureCache;
+    std::size_t scanBytes = 0;
+    for (const auto& region : regions)
+        scanBytes += region.Size;
+
+    auto verifyStart = std::chrono::steady_clock::now();
+    std::vector<const Signatures::Signature*> signatures;
+    std::vector<std::pair<Scanner::Pattern, Scanner::Mode>> batch;
+    std::size_t total = 0;
+    std::vector<const Signatures::Signature*> candidates(std::begin(Signatures::kAll), std::end(Signatures::kAll));
+    for (const auto& patch : ManifestPatches)
+        candidates.push_back(&patch.Signature);
+    for (const auto* signature : candidates) {
+        if (!Signatures::AppliesTo(*signature, eGameType))
+            continue;
+        total++;
+
+        auto mode = signature->All ? Scanner::Mode::All : Scanner::Mode::First;
+        if (const auto* rvas = cache.Find(signature->Pattern, mode)) {
+            auto verified = Memory::VerifyPattern(exeModule, regions, signature->Pattern, *rvas);
+            if (verified.size() == rvas->size()) {
+                SignatureResults[signature] = std::move(verified);
+                continue;
+            }
+            spdlog::warn("Signature Cache: {:s}: Cached address no longer matches, rescanning.", signature->Name);
+        }
+        signatures.push_back(signature);
+        batch.emplace_back(signature->Pattern, mode);
+    }
+    auto verifyTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - verifyStart).count();
+    spdlog::info("Signature Cache: Verified {:d}/{:d} cached signatures in {:.2f}ms.", total - signatures.size(), total, verifyTime);
+
+    if (signatures.empty()) {
+        spdlog::info("----------");
+        return;
+    }
+
+    spdlog::info("Signature Scan: Scanning {:d} of {:d} image bytes ({:d} executable ranges).", scanBytes, Memory::GetModuleInfo(exeModule).SizeOfImage, regions.size());
+
+    auto scanStart = std::chrono::steady_clock::now();
+    auto results = Memory::BatchPatternScan(regions, batch);
+    auto scanTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - scanStart).count();
+
+    std::size_t resolved = 0;
+    for (std::size_t i = 0; i < signatures.size(); ++i) {
+        if (!results[i].empty())
+            resolved++;
+
+        std::vector<std::uint32_t> rvas;
+        for (std::uint8_t* match : results[i])
+            rvas.push_back(static_cast<std::uint32_t>(match - reinterpret_cast<std::uint8_t*>(exeModule)));
+        cache.Store(batch[i].first, batch[i].second, std::move(rvas));
+
+        SignatureResults[signatures[i]] = std::move(results[i]);
+    }
+    spdlog::info("Signature Scan: Resolved {:d}/{:d} signatures in {:.2f}ms ({:d} threads).", resolved, signatures.size(), scanTime, Scanner::DefaultThreads());
+
+    if (cache.Dirty() && !cache.Save())
+        spdlog::warn("Signature Cache: Failed to write {:s}.", (sFixPath / sSigCacheFile).string());
+    spdlog::info("----------");
+}
+
+std::uint8_t* SignatureScan(const Signatures::Signature& signature)
+{
+    auto result = SignatureResults.find(&signature);
+    if (result == SignatureResults.end())
+        return Memory::PatternScan(exeModule, signature.Pattern);
+    return result->second.empty() ? nullptr : result->second.front();
+}
+
+std::vector<std::uint8_t*> SignatureScanAll(const Signatures::Signature& signature)
+{
+    auto result = SignatureResults.find(&signature);
+    if (result == SignatureResults.end())
+        return Memory::PatternScanAll(exeModule, signature.Pattern);
+    return result->second;
+}
+
 void CurrentResolution()
 {
     if (eGameType == Game::GZ || eGameType == Game::TPP) {
         // GZ/TPP: Current resolution
-        std::uint8_t* CurrentResolutionScanResult = Memory::PatternScan(exeModule, "48 89 ?? ?? 48 8B ?? ?? 48 ?? ?? ?? ?? ?? ?? ?? ?? B8 01 00 00 00 48 ?? ?? ??");
+        std::uint8_t* CurrentResolutionScanResult = SignatureScan(Signatures::CurrentResolution);
         if (CurrentResolutionScanResult) {
             spdlog::info("GZ/TPP: Current Resolution: Address is {:s}+{:x}", sExeName.c_str(), CurrentResolutionScanResult - (std::uint8_t*)exeModule);             
             static SafetyHookMid CurrentResolutionMidHook{};
-            CurrentResolutionMidHook = safetyhook::create_mid(CurrentResolutionScanResult,
+            hookTransaction.Mid("CurrentResolution", CurrentResolutionMidHook, CurrentResolutionScanResult,
                 [](SafetyHookContext& ctx) {
                     // Get current resolution
                     int iResX = static_cast<int>(ctx.rax & 0xFFFFFFFF);
@@ -237,6 +634,7 @@ void CurrentResolution()
                         iCurrentResX = iResX;
                         iCurrentResY = iResY;
                         CalculateAspectRatio(true);
+                        hookGroupSwitcher.Request();
                     }
                 });
         }
@@ -252,7 +650,7 @@ void Resolution()
     {
         if (eGameType == Game::GZ || eGameType == Game::TPP) {
             // GZ/TPP: Unlock windowed/borderless resolutions
-            std::uint8_t* WindowedResolutionsScanResult = Memory::PatternScan(exeModule, "72 ?? 0F ?? ?? 73 ?? 80 ?? ?? 00 74 ?? 0F ?? ?? 73 ?? F3 0F ?? ??");
+            std::uint8_t* WindowedResolutionsScanResult = SignatureScan(Signatures::WindowedResolutions);
             if (WindowedResolutionsScanResult) {
                 spdlog::info("GZ/TPP: Unlock Resolutions: Windowed: Address is {:s}+{:x}", sExeName.c_str(), WindowedResolutionsScanResult - (std::uint8_t*)exeModule);
                 Memory::PatchBytes(WindowedResolutionsScanResult, "\xEB\x24", 2); // jmp over resolution restrictions
@@ -265,11 +663,11 @@ void Resolution()
 
         if (eGameType == Game::GZ) {
             // GZ: Remove HWND_TOPMOST flag for borderless mode
-            std::uint8_t* BorderlessTopMostScanResult = Memory::PatternScan(exeModule, "C7 44 ?? ?? ?? ?? ?? ?? 89 ?? ?? ?? 8B ?? ?? 89 ?? ?? ?? FF ?? ?? ?? ?? ?? E9 ?? ?? ?? ??");
+            std::uint8_t* BorderlessTopMostScanResult = SignatureScan(Signatures::BorderlessTopMost);
             if (BorderlessTopMostScanResult) {
                 spdlog::info("GZ: Borderless TopMost: Address is {:s}+{:x}", sExeName.c_str(), BorderlessTopMostScanResult - (std::uint8_t*)exeModule);
                 static SafetyHookMid BorderlessTopMostMidHook{};
-                BorderlessTopMostMidHook = safetyhook::create_mid(BorderlessTopMostScanResult + 0x8,
+                hookTransaction.Mid("BorderlessTopMost", BorderlessTopMostMidHook, BorderlessTopMostScanResult + 0x8,
                     [](SafetyHookContext& ctx) {
                         if (ctx.rdx == (uintptr_t)HWND_TOPMOST)
                             ctx.rdx = (uintptr_t)HWND_NOTOPMOST;
@@ -280,7 +678,7 @@ void Resolution()
             }
 
             // GZ: Unlock fullscreen resolutions
-            std::uint8_t* FullscreenResolutionsScanResult = Memory::PatternScan(exeModule, "F3 0F ?? ?? F3 48 ?? ?? ?? 8B ?? 41 ?? ?? ?? ?? ?? ?? 0F ?? ?? 44 ?? ?? 41 ?? ?? ?? 41 ?? ?? 33 ??");
+            std::uint8_t* FullscreenResolutionsScanResult = SignatureScan(Signatures::FullscreenResolutionsGZ);
             if (FullscreenResolutionsScanResult) {
                 spdlog::info("GZ: Unlock Resolutions: Fullscreen/Borderless: Address is {:s}+{:x}", sExeName.c_str(), FullscreenResolutionsScanResult - (std::uint8_t*)exeModule);
                 Memory::PatchBytes(FullscreenResolutionsScanResult + 0x3, "\xD1", 1); // divss xmm2, xmm0 -> divss xmm2, xmm1 to divide by the actual aspect ratio
@@ -293,7 +691,7 @@ void Resolution()
         else if (eGameType == Game::TPP)
         {
             // TPP: Unlock fullscreen resolutions
-            std::uint8_t* FullscreenResolutionsScanResult = Memory::PatternScan(exeModule, "F3 0F ?? ?? F3 48 ?? ?? ?? B8 ?? ?? ?? ?? 89 ?? 39 ?? 0F ?? ?? 89 ?? ?? ?? 39 ??");
+            std::uint8_t* FullscreenResolutionsScanResult = SignatureScan(Signatures::FullscreenResolutionsTPP);
             if (FullscreenResolutionsScanResult) { 
                 spdlog::info("TPP: Unlock Resolutions: Fullscreen/Borderless: Address is {:s}+{:x}", sExeName.c_str(), FullscreenResolutionsScanResult - (std::uint8_t*)exeModule);
                 Memory::PatchBytes(FullscreenResolutionsScanResult + 0x3, "\xD3", 1); // mulss xmm2, xmm0 -> mulss xmm2, xmm3 to multiply by the actual aspect ratio
@@ -310,7 +708,7 @@ void IntroSkip()
 {
     if (eGameType == Game::TPP) {
         // TPP: Intro logos
-        std::uint8_t* IntroLogosScanResult = Memory::PatternScan(exeModule, "C6 ?? ?? ?? ?? ?? 01 C7 ?? ?? ?? ?? ?? 00 00 00 00 E8 ?? ?? ?? ?? C7 ?? 00 00 00 00 48 89 ??");
+        std::uint8_t* IntroLogosScanResult = SignatureScan(Signatures::IntroLogos);
         if (IntroLogosScanResult) { 
             spdlog::info("TPP: Intro Logos: Address is {:s}+{:x}", sExeName.c_str(), IntroLogosScanResult - (std::uint8_t*)exeModule);
             Memory::PatchBytes(IntroLogosScanResult + 0x6, "\x05", 1);
@@ -328,32 +726,26 @@ void AspectRatio()
     {
         if (eGameType == Game::GZ || eGameType == Game::TPP) {
             // GZ/TPP: Throwable marker
-            std::uint8_t* ThrowableMarkerScanResult = Memory::PatternScan(exeModule, "E8 ?? ?? ?? ?? F3 0F ?? ?? ?? ?? 66 0F ?? ?? 66 0F ?? ?? 41 ?? ?? ?? 4C ?? ?? ?? ?? BA 01 00 00 00");
+            std::uint8_t* ThrowableMarkerScanResult = SignatureScan(Signatures::ThrowableMarker);
             if (ThrowableMarkerScanResult) {
                 spdlog::info("GZ/TPP: Throwable Marker: Address is {:s}+{:x}", sExeName.c_str(), ThrowableMarkerScanResult - (std::uint8_t*)exeModule);
                 static SafetyHookMid ThrowableMarkerMidHook{};
-                ThrowableMarkerMidHook = safetyhook::create_mid(ThrowableMarkerScanResult + 0x5,
-                    [](SafetyHookContext& ctx) {
-                        if (fAspectRatio > fNativeAspect)
-                            ctx.xmm7.f32[0] = fAspectMultiplier;
-                    });
+                hookTransaction.Mid("ThrowableMarker", ThrowableMarkerMidHook, ThrowableMarkerScanResult + 0x5,
+                    [](SafetyHookContext& ctx) { HookCapture::Run<Callbacks::Id::ThrowableMarker>(ctx); });
+                aspectHooks.Add(ThrowableMarkerMidHook);
             }
             else {
                 spdlog::error("GZ/TPP: Throwable Marker: Pattern scan failed.");
             }
 
             // GZ/TPP: Fix lens effects (flares, dirt etc)
-            std::uint8_t* LensEffectsScanResult = Memory::PatternScan(exeModule, "0F 28 ?? F3 ?? 0F ?? ?? ?? ?? ?? ?? F3 45 ?? ?? ?? ?? F3 45 ?? ?? ?? F3 44 ?? ?? ?? ?? E8 ?? ?? ?? ??");
+            std::uint8_t* LensEffectsScanResult = SignatureScan(Signatures::LensEffects);
             if (LensEffectsScanResult) {
                 spdlog::info("GZ/TPP: Lens Effects: Address is {:s}+{:x}", sExeName.c_str(), LensEffectsScanResult - (std::uint8_t*)exeModule);
                 static SafetyHookMid LensEffectsMidHook{};
-                LensEffectsMidHook = safetyhook::create_mid(LensEffectsScanResult + 0x3,
-                    [](SafetyHookContext& ctx) {
-                        if (fAspectRatio > fNativeAspect) {
-                            ctx.xmm13.f32[0] = fNativeAspect;
-                            ctx.xmm9.f32[0] /= fAspectMultiplier;
-                        }
-                    });
+                hookTransaction.Mid("LensEffects", LensEffectsMidHook, LensEffectsScanResult + 0x3,
+                    [](SafetyHookContext& ctx) { HookCapture::Run<Callbacks::Id::LensEffects>(ctx); });
+                aspectHooks.Add(LensEffectsMidHook);
             }
             else {
                 spdlog::error("GZ/TPP: Lens Effects: Pattern scan failed.");
@@ -362,19 +754,15 @@ void AspectRatio()
             // GZ/TPP: Fix depth of field 
             std::uint8_t* DepthOfFieldScanResult = nullptr;   
             if (eGameType == Game::GZ)                                      
-                DepthOfFieldScanResult = Memory::PatternScan(exeModule, "F3 0F ?? ?? ?? ?? ?? ?? 0F ?? ?? 0F ?? ?? ?? ?? ?? ?? 44 0F ?? ?? F3 44 ?? ?? ??");
+                DepthOfFieldScanResult = SignatureScan(Signatures::DepthOfFieldGZ);
             else if (eGameType == Game::TPP)
-                DepthOfFieldScanResult = Memory::PatternScan(exeModule, "F3 0F ?? ?? ?? ?? ?? ?? 0F ?? ?? 0F ?? ?? 0F ?? ?? 0F ?? ?? ?? 0F ?? ?? ?? 0F ?? ?? ?? 44 0F ?? ??");
+                DepthOfFieldScanResult = SignatureScan(Signatures::DepthOfFieldTPP);
             if (DepthOfFieldScanResult) {
                 spdlog::info("GZ/TPP: Depth of Field: Address is {:s}+{:x}", sExeName.c_str(), DepthOfFieldScanResult - (std::uint8_t*)exeModule);
                 static SafetyHookMid DepthOfFieldMidHook{};
-                DepthOfFieldMidHook = safetyhook::create_mid(DepthOfFieldScanResult,
-                    [](SafetyHookContext& ctx) {
-                        if (fAspectRatio > fNativeAspect) {
-                            ctx.xmm6.f32[0] = (fHUDWidth * 0.85f) * (1.00f / 1920.00f);
-                            ctx.xmm4.f32[0] = fHUDWidth;
-                        }
-                    });
+                hookTransaction.Mid("DepthOfField", DepthOfFieldMidHook, DepthOfFieldScanResult,
+                    [](SafetyHookContext& ctx) { HookCapture::Run<Callbacks::Id::DepthOfField>(ctx); });
+                aspectHooks.Add(DepthOfFieldMidHook);
             }
             else {
                 spdlog::error("GZ/TPP: Depth of Field: Pattern scan failed.");
@@ -391,75 +779,19 @@ void HUD()
             // GZ/TPP: Span backgrounds
             std::uint8_t* HUDBackgroundsScanResult = nullptr;
             if (eGameType == Game::GZ)
-                HUDBackgroundsScanResult = Memory::PatternScan(exeModule, "41 0F ?? ?? 8B ?? ?? F6 ?? ?? 0F 84 ?? ?? ?? ?? 44 ?? ?? 41 ?? ?? ?? 41 ?? ?? ?? 74 ??");
+                HUDBackgroundsScanResult = SignatureScan(Signatures::HUDBackgroundsGZ);
             else if (eGameType == Game::TPP)
-                HUDBackgroundsScanResult = Memory::PatternScan(exeModule, "F6 41 ?? 01 74 ?? 0F ?? ?? ?? 0F ?? ?? ?? 44 0F ?? ?? ?? 41 ?? ?? ??");
+                HUDBackgroundsScanResult = SignatureScan(Signatures::HUDBackgroundsTPP);
                 
             if (HUDBackgroundsScanResult) {
                 spdlog::info("GZ/TPP: HUD: Backgrounds: Address is {:s}+{:x}", sExeName.c_str(), HUDBackgroundsScanResult - (std::uint8_t*)exeModule);
-                static SafetyHookMid HUDBackgroundsMidHook{};
-                HUDBackgroundsMidHook = safetyhook::create_mid(HUDBackgroundsScanResult,
-                    [](SafetyHookContext& ctx) {
-                        if (!ctx.rcx)
-                            return;
-
-                        float Width = *reinterpret_cast<float*>(ctx.rcx + 0x30);
-                        float Height = *reinterpret_cast<float*>(ctx.rcx + 0x34);
-
-                        // Different offsets for TPP
-                        if (eGameType == Game::TPP) {
-                            Width = *reinterpret_cast<float*>(ctx.rcx + 0x40);
-                            Height = *reinterpret_cast<float*>(ctx.rcx + 0x44);
-                        }
+                HUDBackgroundsLayout = (eGameType == Game::TPP) ? HUDRules::kLayoutTPP : HUDRules::kLayoutGZ;
+                HUDBackgroundsTable.Build(HUDBackgroundRules, eGameType);
+                spdlog::info("GZ/TPP: HUD: Backgrounds: {:d} rules in {:d} lookup cells.", HUDBackgroundsTable.RuleCount(), HUDBackgroundsTable.CellCount());
 
-                        // Resize HUD to counteract viewport scaling when a movie plays
-                        if (bIsMoviePlaying) {
-                            if (fAspectRatio > fNativeAspect && Width > 1.00f) {
-                                ctx.xmm0.f32[0] *= fAspectMultiplier;
-                            }
-                        }
-
-                        if (fAspectRatio > fNativeAspect) {
-                            // TPP/GZ: ui_sys_cmn_bg
-                            if (Width == 2048.00f && Height == 1152.00f)
-                                ctx.xmm0.f32[0] *= fAspectMultiplier;
-
-                            // TPP/GZ: Cutscene skip BG
-                            if (Width == 2000.00f && Height == 1125.00f)
-                                ctx.xmm0.f32[0] *= fAspectMultiplier;
-
-                            // TPP: Loadout BG
-                            if (Width == 1400.00f && Height == 1400.00f)
-                                ctx.xmm0.f32[0] *= fAspectMultiplier;
-
-                            // TPP/GZ: Mission failed BGs
-                            if (Width == 1500.00f && Height == 1500.00f)
-                                ctx.xmm0.f32[0] *= fAspectMultiplier;
-                            if (Width == 2000.00f && Height == 2000.00f)
-                                ctx.xmm0.f32[0] *= fAspectMultiplier;
-                            if ((Width > 1882.00f && Width < 1884.00f) && (Height > 1059.00f && Height < 1061.00f))
-                                ctx.xmm0.f32[0] *= fAspectMultiplier;
-                            if ((Width > 1770.00f && Width < 1772.00f) && (Height > 995.00f && Height < 997.00f))
-                                ctx.xmm0.f32[0] *= fAspectMultiplier;
-
-                            // TPP/GZ: Scope fade
-                            if (Width == 1400.00f && Height == 1280.00f)
-                                ctx.xmm0.f32[0] *= fAspectMultiplier;
-
-                            // GZ: Scope frame
-                            if (Width == 600.00f && (Height > 1230.00f && Height < 1231.00f))
-                                ctx.xmm0.f32[0] *= fAspectMultiplier;
-
-                            // TPP: Scope frame
-                            if (Width == 1500.00f && Height == 1000.00f)
-                                *reinterpret_cast<float*>(ctx.rcx + 0x740) = fAspectRatio / 2.00f; // Set the overall width scale
-                        }
-                        else {
-                            // TPP: Scope frame
-                            if (Width == 1500.00f && Height == 1000.00f)
-                                *reinterpret_cast<float*>(ctx.rcx + 0x740) = 1.00f; // Reset in-case the resolution has changed.
-                        }
-                    });
+                static SafetyHookMid HUDBackgroundsMidHook{};
+                hookTransaction.Mid("HUDBackgrounds", HUDBackgroundsMidHook, HUDBackgroundsScanResult,
+                    [](SafetyHookContext& ctx) { HookCapture::Run<Callbacks::Id::HUDBackgrounds>(ctx); });
             }
             else {
                 spdlog::error("GZ/TPP: HUD: Backgrounds: Pattern scan failed.");
@@ -468,89 +800,62 @@ void HUD()
 
         if (eGameType == Game::TPP) {
             // TPP: Fix incorrectly positioned markers
-            std::uint8_t* MarkersScanResult = Memory::PatternScan(exeModule, "48 81 ?? ?? ?? ?? ?? E9 ?? ?? ?? ?? 48 8B ?? ?? ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ??");
+            std::uint8_t* MarkersScanResult = SignatureScan(Signatures::Markers);
             if (MarkersScanResult) {
                 spdlog::info("TPP: HUD: Markers: Address is {:s}+{:x}", sExeName.c_str(), MarkersScanResult - (std::uint8_t*)exeModule);
                 static SafetyHookMid MarkersMidHook{};
-                MarkersMidHook = safetyhook::create_mid(MarkersScanResult,
-                    [](SafetyHookContext& ctx) {
-                        if (fAspectRatio > fNativeAspect) {
-                            *reinterpret_cast<float*>(ctx.rdx + 0x120) = 64.00f * fAspectMultiplier;
-                            ctx.xmm1.f32[0] = 64.00f;
-                        }
-                        else {
-                            *reinterpret_cast<float*>(ctx.rdx + 0x120) = 64.00f;
-                            ctx.xmm1.f32[0] = 64.00f;
-                        }
-                    });
+                hookTransaction.Mid("Markers", MarkersMidHook, MarkersScanResult,
+                    [](SafetyHookContext& ctx) { HookCapture::Run<Callbacks::Id::Markers>(ctx); });
             }
             else {
                 spdlog::error("TPP: HUD: Markers: Pattern scan failed.");
             }
 
             // TPP: Marker constraint
-            std::uint8_t* MarkerConstraintScanResult = Memory::PatternScan(exeModule, "F3 0F ?? ?? ?? ?? ?? ?? 0F ?? ?? 77 ?? F3 0F ?? ?? ?? ?? ?? ?? 0F ?? ?? 73 ?? 0F ?? ?? E8 ?? ?? ?? ??");
+            std::uint8_t* MarkerConstraintScanResult = SignatureScan(Signatures::MarkerConstraint);
             if (MarkerConstraintScanResult) {
                 spdlog::info("TPP: HUD: Marker Constraint: Address is {:s}+{:x}", sExeName.c_str(), MarkerConstraintScanResult - (std::uint8_t*)exeModule);
-                static SafetyHookMid MarkerConstraintRightMidHook{};
-                MarkerConstraintRightMidHook = safetyhook::create_mid(MarkerConstraintScanResult + 0x8,
-                    [](SafetyHookContext& ctx) {
-                        if (fAspectRatio > fNativeAspect)
-                            ctx.xmm0.f32[0] *= fAspectMultiplier;
-                    });
+                static CodeCave::Scale MarkerConstraintRightCave{};
+                hookTransaction.Scale("MarkerConstraintRight", MarkerConstraintRightCave, MarkerConstraintScanResult + 0x8, 0, &RenderScale::Snapshot::AspectMultiplier);
+                hudHooks.Add(MarkerConstraintRightCave);
 
-                static SafetyHookMid MarkerConstraintLeftMidHook{};
-                MarkerConstraintLeftMidHook = safetyhook::create_mid(MarkerConstraintScanResult + 0x15,
-                    [](SafetyHookContext& ctx) {
-                        if (fAspectRatio > fNativeAspect)
-                            ctx.xmm0.f32[0] *= fAspectMultiplier;
-                    });
+                static CodeCave::Scale MarkerConstraintLeftCave{};
+                hookTransaction.Scale("MarkerConstraintLeft", MarkerConstraintLeftCave, MarkerConstraintScanResult + 0x15, 0, &RenderScale::Snapshot::AspectMultiplier);
+                hudHooks.Add(MarkerConstraintLeftCave);
             }
             else {
                 spdlog::error("TPP: HUD: Marker Constraint: Pattern scan failed.");
             }
 
             // TPP: Fix various overlays
-            std::vector<std::uint8_t*> OverlayScanResult = Memory::PatternScanAll(exeModule, "F3 0F ?? ?? ?? ?? ?? ?? C7 44 ?? ?? 00 00 80 BF C7 44 ?? ?? 00 00 80 3F");
+            std::vector<std::uint8_t*> OverlayScanResult = SignatureScanAll(Signatures::Overlays);
             if (!OverlayScanResult.empty() && OverlayScanResult.size() == 3) {
                 spdlog::info("TPP: HUD: Overlays: 1: Address is {:s}+{:x}", sExeName.c_str(), OverlayScanResult[0] - (std::uint8_t*)exeModule);
-                static SafetyHookMid Overlay1MidHook{};
-                Overlay1MidHook = safetyhook::create_mid(OverlayScanResult[0],
-                    [](SafetyHookContext& ctx) {
-                        if (fAspectRatio > fNativeAspect)
-                            ctx.xmm5.f32[0] *= fAspectMultiplier;
-                    });
+                static CodeCave::Scale Overlay1Cave{};
+                hookTransaction.Scale("Overlay1", Overlay1Cave, OverlayScanResult[0], 5, &RenderScale::Snapshot::AspectMultiplier);
+                hudHooks.Add(Overlay1Cave);
 
                 spdlog::info("TPP: HUD: Overlays: 2: Address is {:s}+{:x}", sExeName.c_str(), OverlayScanResult[1] - (std::uint8_t*)exeModule);
-                static SafetyHookMid Overlay2MidHook{};
-                Overlay2MidHook = safetyhook::create_mid(OverlayScanResult[1],
-                    [](SafetyHookContext& ctx) {
-                        if (fAspectRatio > fNativeAspect)
-                            ctx.xmm5.f32[0] *= fAspectMultiplier;
-                    });
+                static CodeCave::Scale Overlay2Cave{};
+                hookTransaction.Scale("Overlay2", Overlay2Cave, OverlayScanResult[1], 5, &RenderScale::Snapshot::AspectMultiplier);
+                hudHooks.Add(Overlay2Cave);
 
                 spdlog::info("TPP: HUD: Overlays: 3: Address is {:s}+{:x}", sExeName.c_str(), OverlayScanResult[2] - (std::uint8_t*)exeModule);
-                static SafetyHookMid Overlay3MidHook{};
-                Overlay3MidHook = safetyhook::create_mid(OverlayScanResult[2],
-                    [](SafetyHookContext& ctx) {
-                        if (fAspectRatio > fNativeAspect)
-                            ctx.xmm5.f32[0] *= fAspectMultiplier;
-                    });
+                static CodeCave::Scale Overlay3Cave{};
+                hookTransaction.Scale("Overlay3", Overlay3Cave, OverlayScanResult[2], 5, &RenderScale::Snapshot::AspectMultiplier);
+                hudHooks.Add(Overlay3Cave);
             }
             else {
                 spdlog::error("TPP: HUD: Overlays: Pattern scan failed.");
             }
 
             // TPP: Fix sonar markers
-            std::uint8_t* ViewportScanResult = Memory::PatternScan(exeModule, "F3 0F ?? ?? ?? ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ?? F3 0F ?? ?? F3 0F ?? ?? ?? 48 83 ?? ??");
+            std::uint8_t* ViewportScanResult = SignatureScan(Signatures::SonarMarkers);
             if (ViewportScanResult) {
                 spdlog::info("TPP: HUD: Sonar Markers: Address is {:s}+{:x}", sExeName.c_str(), ViewportScanResult - (std::uint8_t*)exeModule);
-                static SafetyHookMid ViewportMidHook{};
-                ViewportMidHook = safetyhook::create_mid(ViewportScanResult,
-                    [](SafetyHookContext& ctx) {
-                        if (fAspectRatio > fNativeAspect)
-                            ctx.xmm0.f32[0] *= fAspectMultiplier;
-                    });
+                static CodeCave::Scale ViewportCave{};
+                hookTransaction.Scale("SonarMarkers", ViewportCave, ViewportScanResult, 0, &RenderScale::Snapshot::AspectMultiplier);
+                hudHooks.Add(ViewportCave);
             }
             else {
                 spdlog::error("TPP: HUD: Sonar Markers: Pattern scan failed.");
@@ -565,50 +870,38 @@ void Movies()
     {
         if (eGameType == Game::TPP) {
             // TPP: Adjust movie frame
-            std::uint8_t* MovieFrameScanResult = Memory::PatternScan(exeModule, "72 ?? 44 0F ?? ?? 72 ?? 41 0F ?? ?? F3 41 ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ?? 0F ?? ?? 76 ??");
+            std::uint8_t* MovieFrameScanResult = SignatureScan(Signatures::MovieFrame);
             if (MovieFrameScanResult) {
                 spdlog::info("TPP: HUD: Movie Frame: Address is {:s}+{:x}", sExeName.c_str(), MovieFrameScanResult - (std::uint8_t*)exeModule);
                 static SafetyHookMid MovieFrameMidHook{};
-                MovieFrameMidHook = safetyhook::create_mid(MovieFrameScanResult,
-                    [](SafetyHookContext& ctx) {
-                        if (fAspectRatio > fNativeAspect)
-                            ctx.rflags |= (1ULL << 0); // Set CF
-                    });
+                hookTransaction.Mid("MovieFrame", MovieFrameMidHook, MovieFrameScanResult,
+                    [](SafetyHookContext& ctx) { HookCapture::Run<Callbacks::Id::MovieFrame>(ctx); });
+                movieHooks.Add(MovieFrameMidHook);
             }
             else {
                 spdlog::error("TPP: HUD: Movie Frame: Pattern scan failed.");
             }
 
             // TPP: Movie status
-            std::uint8_t* MovieStatusScanResult = Memory::PatternScan(exeModule, "8B ?? ?? ?? ?? ?? FF ?? 0F 84 ?? ?? ?? ?? FF ?? 0F 84 ?? ?? ?? ?? FF ?? 74 ?? 48 8D ?? ?? ?? ?? ?? 33 ??");
+            std::uint8_t* MovieStatusScanResult = SignatureScan(Signatures::MovieStatus);
             if (MovieStatusScanResult) {
                 spdlog::info("TPP: HUD: Movie Status: Address is {:s}+{:x}", sExeName.c_str(), MovieStatusScanResult - (std::uint8_t*)exeModule);
                 static SafetyHookMid MovieStatusMidHook{};
-                MovieStatusMidHook = safetyhook::create_mid(MovieStatusScanResult,
-                    [](SafetyHookContext& ctx) {
-                        // Playing/paused
-                        if (ctx.rax == 1 || ctx.rax == 2)
-                            bIsMoviePlaying = true;
-                        else
-                            bIsMoviePlaying = false;
-                    });
+                hookTransaction.Mid("MovieStatus", MovieStatusMidHook, MovieStatusScanResult,
+                    [](SafetyHookContext& ctx) { HookCapture::Run<Callbacks::Id::MovieStatus>(ctx); });
             }
             else {
                 spdlog::error("TPP: HUD: Movie Status: Pattern scan failed.");
             }
 
             // TPP: Viewport
-            std::uint8_t* ViewportScanResult = Memory::PatternScan(exeModule, "F3 0F ?? ?? F3 0F ?? ?? 0F ?? ?? 73 ?? 41 0F ?? ?? 41 ?? ?? 44 ?? ?? F3 0F ?? ?? F3 0F ?? ??");
+            std::uint8_t* ViewportScanResult = SignatureScan(Signatures::MovieViewport);
             if (ViewportScanResult) {
                 spdlog::info("TPP: HUD: Viewport: Address is {:s}+{:x}", sExeName.c_str(), ViewportScanResult - (std::uint8_t*)exeModule);
                 static SafetyHookMid ViewportMidHook{};
-                ViewportMidHook = safetyhook::create_mid(ViewportScanResult,
-                    [](SafetyHookContext& ctx) {
-                        if (bIsMoviePlaying) {
-                            if (fAspectRatio > fNativeAspect)
-                                ctx.xmm1.f32[0] = fHUDWidth;
-                        }
-                    });
+                hookTransaction.Mid("Viewport", ViewportMidHook, ViewportScanResult,
+                    [](SafetyHookContext& ctx) { HookCapture::Run<Callbacks::Id::MovieViewport>(ctx); });
+                movieHooks.Add(ViewportMidHook);
             }
             else {
                 spdlog::error("TPP: HUD: Viewport: Pattern scan failed.");
@@ -617,43 +910,98 @@ void Movies()
     }  
 }
 
+void GovernLOD(LODGovernor::Controller& governor, std::chrono::steady_clock::duration frameTime)
+{
+    auto decision = governor.Add(std::chrono::duration<float, std::milli>(frameTime).count());
+    if (!decision)
+        return;
+
+    Callbacks::governedLOD.ModelDistance.store(decision->ModelDistance, std::memory_order_relaxed);
+    Callbacks::governedLOD.GrassDistance.store(decision->GrassDistance, std::memory_order_relaxed);
+
+    // Runs on the main thread, the logging thread started by LODGovernorSetup() writes it out
+    lodDecisions.Push(*decision);
+}
+
+void LODGovernorSetup()
+{
+    if (bLODGovernor) {
+        // Frames are counted by the thread sleep hook
+        if (!bUnlockFPS) {
+            spdlog::error("LOD Governor: Needs [Unlock Framerate] enabled, using fixed distances.");
+            return;
+        }
+
+        // The LOD Tweaks distances are the maximums
+        LODGovernor::Settings settings;
+        settings.TargetMs = std::max(fGovernorTargetFrameTime, 1.00f);
+        settings.Hysteresis = std::clamp(iGovernorHysteresis, 0, 50) / 100.00f;
+        settings.MinModelDistance = std::min(fGovernorMinModelDistance, fModelDistance);
+        settings.MaxModelDistance = fModelDistance;
+        settings.MinGrassDistance = std::min(fGovernorMinGrassDistance, fGrassDistance);
+        settings.MaxGrassDistance = fGrassDistance;
+
+        static std::optional<LODGovernor::Controller> governor;
+        governor.emplace(settings);
+        lodGovernor.store(&*governor, std::memory_order_release);
+        spdlog::info("LOD Governor: Targeting {:.2f}ms frames, model distance {:.0f}-{:.0f}, grass distance {:.0f}-{:.0f}.",
+            settings.TargetMs, settings.MinModelDistance, settings.MaxModelDistance, settings.MinGrassDistance, settings.MaxGrassDistance);
+
+        // Decisions are logged from here rather than the main thread, whichever way logging is set up
+        std::thread([] {
+            for (;;) {
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+                LODGovernor::Decision decision;
+                while (lodDecisions.Pop(decision)) {
+                    spdlog::info("LOD Governor: {:s} model distance to {:.0f} and grass distance to {:.0f} ({:.0f}%), frames averaged {:.2f}ms.",
+                        decision.Raised ? "Raised" : "Lowered", decision.ModelDistance, decision.GrassDistance, decision.Level * 100.00f, decision.WindowMs);
+                }
+                if (std::uint64_t dropped = lodDecisions.TakeDropped())
+                    spdlog::warn("LOD Governor: {:d} more decision(s) not logged.", dropped);
+            }
+        }).detach();
+    }
+}
+
+void RaiseTimerResolution()
+{
+    if (fTimerResolution <= 0.00f)
+        return;
+
+    // Raised once for the whole process, restored when the fix unloads
+    auto requested = static_cast<ULONG>(std::clamp(fTimerResolution, 0.10f, 15.60f) * 10000.00f);
+    if (!timerResolution.Request(requested)) {
+        spdlog::error("GZ/TPP: Timer: Failed to set timer resolution to {:.2f}ms.", requested / 10000.00f);
+        return;
+    }
+    bTimerResolutionRaised = true;
+    spdlog::info("GZ/TPP: Timer: Requested {:.2f}ms, granted {:.2f}ms (was {:.2f}ms, finest supported {:.2f}ms).",
+        requested / 10000.00f, timerResolution.Granted() / 10000.00f, timerResolution.Original() / 10000.00f, timerResolution.Finest() / 10000.00f);
+}
+
+void TimerJitter()
+{
+    // Sleeps for ~100ms, so only after the hooks are in
+    if (bTimerResolutionRaised) {
+        auto jitter = TimerResolution::MeasureSleepJitter();
+        spdlog::info("GZ/TPP: Timer: Sleep(1) wakes {:.0f}us late on average, {:.0f}us at p99, {:.0f}us at worst.", jitter.MeanUs, jitter.P99Us, jitter.MaxUs);
+    }
+}
+
 void Framerate()
 {
     if (bUnlockFPS)
     {
         if (eGameType == Game::GZ || eGameType == Game::TPP) {
             // GZ/TPP: Force "variable" framerate setting
-            std::uint8_t* FramerateSettingScanResult = Memory::PatternScan(exeModule, "48 33 ?? ?? ?? ?? ?? 49 85 ?? 48 0F ?? ?? ?? ?? ?? ?? 48 89 ?? ?? ?? ??");
-            std::uint8_t* FramerateTargetScanResult = Memory::PatternScan(exeModule, "49 85 ?? 75 ?? F2 0F 10 0D ?? ?? ?? ??");
+            std::uint8_t* FramerateSettingScanResult = SignatureScan(Signatures::FramerateSetting);
+            std::uint8_t* FramerateTargetScanResult = SignatureScan(Signatures::FramerateTarget);
             if (FramerateSettingScanResult && FramerateTargetScanResult) { 
                 spdlog::info("GZ/TPP: Framerate: Setting: Address is {:s}+{:x}", sExeName.c_str(), FramerateSettingScanResult - (std::uint8_t*)exeModule);
                 Memory::PatchBytes(FramerateSettingScanResult, "\x48\x31\xC0\x90\x90\x90\x90", 7); // xor rax, rax
                 spdlog::info("GZ/TPP: Framerate: Setting: Patched instruction.");
 
-                static SafetyHookMid TimerResolutionMidHook{};
-                TimerResolutionMidHook = safetyhook::create_mid(FramerateSettingScanResult,
-                    [](SafetyHookContext& ctx) {
-                        typedef NTSTATUS(NTAPI* _NtSetTimerResolution)(ULONG DesiredResolution, BOOLEAN SetResolution, PULONG CurrentResolution);
-                        _NtSetTimerResolution NtSetTimerResolution;
-    
-                        HMODULE ntdll = GetModuleHandleA("ntdll.dll");
-                        if (ntdll) {
-                            FARPROC NtSetTimerResolution_fn = GetProcAddress(ntdll, "NtSetTimerResolution");
-                            if (NtSetTimerResolution_fn) {
-                                NtSetTimerResolution = (_NtSetTimerResolution)NtSetTimerResolution_fn;
-                            }
-                        }
-    
-                        if (NtSetTimerResolution) {
-                            ULONG currentRes;
-                            NTSTATUS status = NtSetTimerResolution(5000, TRUE, &currentRes);
-                            
-                            if (status == 0) {
-                                spdlog::info("GZ/TPP: Timer: Set timer resolution to 0.5ms");
-                            }
-                        }
-    
-                    });
+                RaiseTimerResolution();
 
                 spdlog::info("GZ/TPP: Framerate: Target: Address is {:s}+{:x}", sExeName.c_str(), FramerateTargetScanResult - (std::uint8_t*)exeModule);
                 Memory::PatchBytes(FramerateTargetScanResult + 0x3, "\xEB", 1); // jmp
@@ -664,15 +1012,34 @@ void Framerate()
             }
 
             // GZ/TPP: Thread sleep
-            std::uint8_t* ThreadSleepScanResult = Memory::PatternScan(exeModule, "48 ?? ?? 48 85 ?? 75 ?? 8D ?? 01 48 8D ?? ?? ??");
+            std::uint8_t* ThreadSleepScanResult = SignatureScan(Signatures::ThreadSleep);
             if (ThreadSleepScanResult) { 
                 spdlog::info("GZ/TPP: Thread Sleep: Address is {:s}+{:x}", sExeName.c_str(), ThreadSleepScanResult - (std::uint8_t*)exeModule);
+
+                // Pace the main thread ourselves instead of letting it run flat out
+                framePacer.SetTarget(iMaxFPS);
+                if (framePacer.Enabled())
+                    spdlog::info("GZ/TPP: Frame Limiter: Capped at {:d} FPS ({:s} timer).", iMaxFPS, framePacer.PreciseTimer() ? "high resolution" : "standard");
+
                 static SafetyHookMid ThreadSleepMidHook{};
-                ThreadSleepMidHook = safetyhook::create_mid(ThreadSleepScanResult + 0xB,
+                hookTransaction.Mid("ThreadSleep", ThreadSleepMidHook, ThreadSleepScanResult + 0xB, safetyhook::reg::rbp | safetyhook::reg::rdx,
                     [](SafetyHookContext& ctx) {
                         // "MainThrd"
-                        if (ctx.rbp == 0x01)
+                        if (ctx.rbp == 0x01) {
+                            threadRegistry.Learn("MainThrd");
+
+                            // Frame time without the limiter's wait, so a frame cap doesn't look like load
+                            static auto frameStart = std::chrono::steady_clock::now();
+                            auto frameTime = std::chrono::steady_clock::now() - frameStart;
+                            framePacer.Wait();
+                            frameStart = std::chrono::steady_clock::now();
                             ctx.rdx = 0;
+
+                            if (auto* governor = lodGovernor.load(std::memory_order_acquire))
+                                GovernLOD(*governor, frameTime);
+                            Profiler::Frame();
+                            Telemetry::Frame();
+                        }
                     });
             }
             else {
@@ -682,7 +1049,7 @@ void Framerate()
 
         if (eGameType == Game::GZ) {
             // GZ: Fix freezing bug with throwables when using variable framerate
-            std::uint8_t* ThrowableBugScanResult = Memory::PatternScan(exeModule, "F2 0F 59 ?? ?? ?? ?? ?? 66 0F ?? ?? F7 ?? ?? ?? ?? ?? 00 01 00 00 74 ??");
+            std::uint8_t* ThrowableBugScanResult = SignatureScan(Signatures::ThrowableBug);
             if (ThrowableBugScanResult) { 
                 spdlog::info("GZ: Framerate: Throwable Framerate Bug: Address is {:s}+{:x}", sExeName.c_str(), ThrowableBugScanResult - (std::uint8_t*)exeModule);
                 Memory::PatchBytes(ThrowableBugScanResult, "\xF2\x0F\x59\x40\x30\x90\x90\x90", 8); // mulsd xmm0,[7FF677CA9C00] (fixed 60fps frametime) -> mulsd xmm0, [rax+30] (current frametime)
@@ -701,11 +1068,11 @@ void Graphics()
     {
         if (eGameType == Game::TPP) {
             // TPP: LOD factor resolution
-            std::uint8_t* LODFactorResolutionScanResult = Memory::PatternScan(exeModule, "8B ?? ?? ?? ?? ?? 4C 8B ?? ?? ?? ?? ?? 85 ?? 75 ?? 8B ?? ?? ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ??");
+            std::uint8_t* LODFactorResolutionScanResult = SignatureScan(Signatures::LODFactorResolutionTPP);
             if (LODFactorResolutionScanResult) { 
                 spdlog::info("TPP: Graphics: LOD: LOD Factor Resolution: Address is {:s}+{:x}", sExeName.c_str(), LODFactorResolutionScanResult - (std::uint8_t*)exeModule);
-                std::uint8_t* LODFactorResolution = Memory::GetAbsolute(LODFactorResolutionScanResult + 0x2);
-                Memory::Write(LODFactorResolution, iTerrainDistance);
+                TPPLODFactorResolution = Memory::GetAbsolute(LODFactorResolutionScanResult + 0x2);
+                Memory::Write(TPPLODFactorResolution, iTerrainDistance);
             }
             else {
                 spdlog::error("TPP: Graphics: LOD: LOD Factor Resolution: Pattern scan failed.");
@@ -713,14 +1080,12 @@ void Graphics()
         }
         else if (eGameType == Game::GZ) {
             // GZ: LOD factor resolution
-            std::uint8_t* LODFactorResolutionScanResult = Memory::PatternScan(exeModule, "66 0F ?? ?? ?? ?? ?? ?? 0F 29 ?? ?? 0F 28 ?? F3 0F ?? ?? ?? ?? ?? ?? 0F 5B ??");
+            std::uint8_t* LODFactorResolutionScanResult = SignatureScan(Signatures::LODFactorResolutionGZ);
             if (LODFactorResolutionScanResult) { 
                 spdlog::info("GZ: Graphics: LOD: LOD Factor Resolution: Address is {:s}+{:x}", sExeName.c_str(), LODFactorResolutionScanResult - (std::uint8_t*)exeModule);
                 static SafetyHookMid LODFactorResolutionMidHook{};
-                LODFactorResolutionMidHook = safetyhook::create_mid(LODFactorResolutionScanResult + 0x8,
-                    [](SafetyHookContext& ctx) {
-                        ctx.xmm3.u16[0] = iTerrainDistance;
-                    });
+                hookTransaction.Mid("LODFactorResolution", LODFactorResolutionMidHook, LODFactorResolutionScanResult + 0x8,
+                    [](SafetyHookContext& ctx) { HookCapture::Run<Callbacks::Id::LODFactorResolution>(ctx); });
             }
             else {
                 spdlog::error("GZ: Graphics: LOD: LOD Factor Resolution: Pattern scan failed.");
@@ -729,17 +1094,13 @@ void Graphics()
 
         if (eGameType == Game::GZ || eGameType == Game::TPP) {
             // GZ/TPP: Model quality
-            std::uint8_t* ModelQualityScanResult = Memory::PatternScan(exeModule, "89 ?? 64 B0 01 C3 8B ?? ?? C6 ?? ?? 00 89 ?? ?? B0 01 C3");
+            std::uint8_t* ModelQualityScanResult = SignatureScan(Signatures::ModelQuality);
             if (ModelQualityScanResult) { 
                 spdlog::info("GZ/TPP: Graphics: LOD: Model/Grass LOD Distance: Address is {:s}+{:x}", sExeName.c_str(), ModelQualityScanResult - (std::uint8_t*)exeModule);
                 static SafetyHookMid ModelQualityMidHook{};
-                ModelQualityMidHook = safetyhook::create_mid(ModelQualityScanResult,
-                    [](SafetyHookContext& ctx) {
-                        if (ctx.rbx == 9)
-                            ctx.rax = *(uint32_t*)&fGrassDistance;
-                        else
-                            ctx.rax = *(uint32_t*)&fModelDistance;
-                    });
+                hookTransaction.Mid("ModelQuality", ModelQualityMidHook, ModelQualityScanResult,
+                    [](SafetyHookContext& ctx) { HookCapture::Run<Callbacks::Id::ModelQuality>(ctx); });
+                LODGovernorSetup();
             }
             else {
                 spdlog::error("GZ/TPP: Graphics: LOD: Model/Grass LOD Distance: Pattern scan failed.");
@@ -748,20 +1109,216 @@ void Graphics()
     }   
 }
 
+void PatchManifest()
+{
+    static std::array<SafetyHookMid, Manifest::kMaxScaleHooks> ScaleMidHooks{};
+    static std::deque<CodeCave::Scale> ScaleCaves;
+    std::size_t scaleHooks = 0;
+
+    for (const auto& patch : ManifestPatches) {
+        if (!Signatures::AppliesTo(patch.Signature, eGameType))
+            continue;
+
+        const char* name = patch.Name.c_str();
+        std::vector<std::uint8_t*> matches = SignatureScanAll(patch.Signature);
+        if (matches.empty()) {
+            spdlog::error("Patch Manifest: {:s}: Pattern scan failed.", name);
+            continue;
+        }
+        if (patch.Matches && matches.size() != patch.Matches) {
+            spdlog::error("Patch Manifest: {:s}: Expected {:d} match(es) but found {:d}, skipping.", name, patch.Matches, matches.size());
+            continue;
+        }
+
+        for (std::uint8_t* match : matches) {
+            std::uint8_t* address = match + patch.Offset;
+            spdlog::info("Patch Manifest: {:s}: Address is {:s}+{:x}", name, sExeName.c_str(), address - (std::uint8_t*)exeModule);
+
+            switch (patch.Do) {
+            case Manifest::Action::Bytes:
+                Memory::PatchBytes(address, reinterpret_cast<const char*>(patch.Bytes.data()), static_cast<unsigned int>(patch.Bytes.size()));
+                spdlog::info("Patch Manifest: {:s}: Patched instruction.", name);
+                break;
+            case Manifest::Action::WriteInt:
+                Memory::Write(Memory::GetAbsolute(address), patch.IntValue);
+                spdlog::info("Patch Manifest: {:s}: Wrote {:d} to {:s}+{:x}.", name, patch.IntValue, sExeName.c_str(), Memory::GetAbsolute(address) - (std::uint8_t*)exeModule);
+                break;
+            case Manifest::Action::WriteFloat:
+                Memory::Write(Memory::GetAbsolute(address), patch.FloatValue);
+                spdlog::info("Patch Manifest: {:s}: Wrote {} to {:s}+{:x}.", name, patch.FloatValue, sExeName.c_str(), Memory::GetAbsolute(address) - (std::uint8_t*)exeModule);
+                break;
+            case Manifest::Action::Scale:
+                // Multiplies don't need to leave native code
+                if (patch.Scale.Do == Manifest::Op::Multiply) {
+                    auto xmm = static_cast<std::uint8_t>((patch.Scale.Register - offsetof(SafetyHookContext, xmm0)) / sizeof(SafetyHookContext::xmm0));
+                    auto& cave = ScaleCaves.emplace_back();
+                    hookTransaction.Scale(name, cave, address, xmm, patch.Scale.Value, patch.Scale.WiderOnly);
+                    if (patch.Scale.WiderOnly)
+                        manifestHooks.Add(cave);
+                    break;
+                }
+                if (scaleHooks == Manifest::kMaxScaleHooks) {
+                    spdlog::error("Patch Manifest: {:s}: Only {:d} scale hooks are supported, skipping.", name, Manifest::kMaxScaleHooks);
+                    break;
+                }
+                Manifest::scaleHooks[scaleHooks] = patch.Scale;
+                Manifest::WithScaleCallback(scaleHooks, [&](auto callback) {
+                    hookTransaction.Mid(name, ScaleMidHooks[scaleHooks], address, callback);
+                });
+                if (patch.Scale.WiderOnly)
+                    manifestHooks.Add(ScaleMidHooks[scaleHooks]);
+                scaleHooks++;
+                break;
+            }
+        }
+    }
+}
+
+void HookCaptureSetup()
+{
+    if (bHookCapture) {
+        // Everything the replay needs to rebuild the callbacks' state
+        const auto& layout = (eGameType == Game::TPP) ? HUDRules::kLayoutTPP : HUDRules::kLayoutGZ;
+        HookCapture::FileHeader header{};
+        std::memcpy(header.Magic, HookCapture::kMagic, sizeof(header.Magic));
+        header.Game = static_cast<std::uint8_t>(eGameType);
+        header.TerrainDistance = iTerrainDistance;
+        header.ModelDistance = fModelDistance;
+        header.GrassDistance = fGrassDistance;
+        header.HUDWidthOffset = static_cast<std::uint32_t>(layout.WidthOffset);
+        header.HUDHeightOffset = static_cast<std::uint32_t>(layout.HeightOffset);
+        header.HUDScaleOffset = static_cast<std::uint32_t>(layout.ScaleOffset);
+
+        iHookCaptureRecords = std::max(iHookCaptureRecords, 1);
+        auto capturePath = sExePath / (sFixName + "_hooks.bin");
+        if (hookCapture.Open(capturePath, header, static_cast<std::uint32_t>(iHookCaptureRecords))) {
+            HookCapture::active.store(&hookCapture, std::memory_order_relaxed);
+            spdlog::info("Hook Capture: Recording up to {:d} calls per hook to {:s}.", iHookCaptureRecords, capturePath.string());
+        }
+        else {
+            spdlog::error("Hook Capture: Failed to open {:s}.", capturePath.string());
+        }
+    }
+}
+
+void ThreadPolicySetup()
+{
+    if (bThreadPolicy) {
+        // Threads are learned from the thread sleep hook
+        if (!bUnlockFPS) {
+            spdlog::error("Thread Policy: Needs [Unlock Framerate] enabled, not applying.");
+            return;
+        }
+
+        auto machine = Topology::Detect();
+        if (machine.Processors.empty()) {
+            spdlog::error("Thread Policy: Failed to read the CPU topology.");
+            return;
+        }
+        std::uint8_t fastest = 0;
+        for (const auto& processor : machine.Processors)
+            fastest = std::max(fastest, processor.Efficiency);
+        std::size_t cores = std::size_t(machine.Processors.back().Core) + 1;
+        spdlog::info("Thread Policy: {:d} logical processors, {:d} cores, {:d} L3 domain(s), best is domain {:d}{:s}.", machine.Processors.size(), cores,
+            machine.DomainCacheKB.size(), Topology::BestDomain(machine), fastest ? " (hybrid)" : "");
+        for (std::size_t domain = 0; domain < machine.DomainCacheKB.size(); ++domain)
+            spdlog::info("Thread Policy: L3 domain {:d}: {:d}KB", domain, machine.DomainCacheKB[domain]);
+
+        auto plan = Topology::Plan(machine, ThreadRules);
+        for (const auto& assignment : plan)
+            spdlog::info("Thread Policy: {:s}: {:s}.", assignment.Thread, assignment.Reason);
+        threadRegistry.SetPolicy(std::move(plan));
+    }
+}
+
+void FrameTelemetry()
+{
+    if (bFrameTelemetry) {
+        // Frames are counted by the thread sleep hook
+        if (!bUnlockFPS) {
+            spdlog::error("Frame Telemetry: Needs [Unlock Framerate] enabled, not recording.");
+            return;
+        }
+
+        iTelemetryInterval = std::max(iTelemetryInterval, 1);
+        auto csvPath = sExePath / (sFixName + "_frametimes.csv");
+        if (Telemetry::Start(csvPath, std::chrono::seconds(iTelemetryInterval)))
+            spdlog::info("Frame Telemetry: Writing frame times to {:s} every {:d}s.", csvPath.string(), iTelemetryInterval);
+        else
+            spdlog::error("Frame Telemetry: Failed to open {:s}.", csvPath.string());
+    }
+}
+
+// Fix groups by priority. Priority 0 matters from the first frame (resolution, framerate) and is
+// patched in as soon as the scan is done, the rest follow in a second hook transaction.
+struct FixGroup
+{
+    const char* Name;
+    int Priority;
+    void (*Apply)();
+};
+
+const FixGroup kFixGroups[] = {
+    { "CurrentResolution",  0, CurrentResolution },
+    { "Resolution",         0, Resolution },
+    { "Framerate",          0, Framerate },
+    //{ "IntroSkip",        1, IntroSkip },
+    { "AspectRatio",        1, AspectRatio },
+    { "HUD",                1, HUD },
+    { "Movies",             1, Movies },
+    { "Graphics",           1, Graphics },
+    { "PatchManifest",      1, PatchManifest },
+};
+
+bool ApplyFixes(int priority)
+{
+    for (const auto& group : kFixGroups) {
+        if (group.Priority == priority)
+            group.Apply();
+    }
+    // The commit enables every new hook, including ones whose group is off
+    bool committed = hookTransaction.Commit();
+    hookGroupSwitcher.Request();
+    return committed;
+}
+
 DWORD __stdcall Main(void*)
 {
     Logging();
-    Configuration();
-    if (DetectGame())
-    {
-        CurrentResolution();
-        Resolution();
-        //IntroSkip();
-        AspectRatio();
-        HUD();
-        Movies();
-        Framerate();
-        Graphics();
+
+    // Reading the ini, finding the game and indexing the exe don't depend on each other.
+    Startup::Pipeline startup(loadTime);
+    startup.Add("Configuration", {}, [] { return Configuration(); });
+    startup.Add("Detect Game", {}, [] { return DetectGame(); });
+    startup.Add("Module Index", {}, [] { IndexModule(); return true; });
+    startup.Add("Patch Manifest", {}, [] { LoadPatchManifest(); return true; });
+    startup.Add("Signature Scan", { "Detect Game", "Module Index", "Patch Manifest" }, [] { ScanSignatures(); return true; });
+    // Swapping the sinks can't overlap a stage that logs, so every stage comes before or after it.
+    startup.Add("Async Logging", { "Configuration", "Signature Scan" }, [] { AsyncLogging(); return true; });
+    startup.Add("Hook Capture", { "Async Logging" }, [] { HookCaptureSetup(); return true; });
+    startup.Add("Thread Policy", { "Async Logging" }, [] { ThreadPolicySetup(); return true; });
+    startup.Add("Critical Hooks", { "Async Logging", "Hook Capture", "Thread Policy" }, [] { return ApplyFixes(0); });
+    startup.Add("Hooks", { "Critical Hooks" }, [] { return ApplyFixes(1); });
+    startup.Run();
+
+    if (!startup.Succeeded("Configuration")) {
+        // The scan may have run alongside the ini, its workers can't outlive the DLL.
+        Scanner::WorkerPool::Get().Stop();
+        spdlog::shutdown();
+        FreeLibraryAndExitThread(thisModule, 1);
+    }
+
+    spdlog::info("----------");
+    startup.Report();
+    if (startup.Succeeded("Hooks"))
+        spdlog::info("Startup: All hooks active {:.2f}ms after load (critical hooks after {:.2f}ms).", startup.FinishedAt("Hooks"), startup.FinishedAt("Critical Hooks"));
+    spdlog::info("----------");
+
+    if (startup.Succeeded("Detect Game")) {
+        Profiler::Start();
+        FrameTelemetry();
+        ConfigWatcher();
+        TimerJitter();
     }
     return true;
 }
@@ -773,6 +1330,7 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserv
     case DLL_PROCESS_ATTACH:
     {
         thisModule = hModule;
+        loadTime = Startup::Clock::now();
 
         HANDLE mainHandle = CreateThread(NULL, 0, Main, 0, NULL, 0);
         if (mainHandle)
@@ -782,9 +1340,11 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserv
         }
         break;
     }
+    case DLL_PROCESS_DETACH:
+        timerResolution.Restore();
+        break;
     case DLL_THREAD_ATTACH:
     case DLL_THREAD_DETACH:
-    case DLL_PROCESS_DETACH:
         break;
     }
     return TRUE;
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <chrono>
+#include <thread>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#define FRAMELIMITER_PAUSE() _mm_pause()
+#else
+#define FRAMELIMITER_PAUSE() std::this_thread::yield()
+#endif
+
+// Frame pacing against an absolute deadline: sleep on a timer until shortly before the deadline,
+// then spin the rest of the way. Only Timer touches the OS, so Pacer runs anywhere.
+namespace FrameLimiter
+{
+    using Clock = std::chrono::steady_clock;
+
+    // How long before the deadline to stop sleeping and start spinning. A high resolution waitable
+    // timer wakes within a few hundred microseconds, the regular one is only as good as the system
+    // timer resolution (see [Unlock Framerate] TimerResolution).
+    constexpr auto kSpinWindowPrecise = std::chrono::microseconds(300);
+    constexpr auto kSpinWindowCoarse = std::chrono::microseconds(1500);
+
+    class Timer
+    {
+    public:
+#if defined(_WIN32)
+        Timer()
+        {
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+            // High resolution timers need Windows 10 1803+, fall back to a regular one before that.
+            handle = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+            precise = handle != nullptr;
+            if (!handle)
+                handle = CreateWaitableTimerW(nullptr, TRUE, nullptr);
+        }
+
+        ~Timer()
+        {
+            if (handle)
+                CloseHandle(handle);
+        }
+
+        void SleepFor(Clock::duration duration)
+        {
+            if (!handle) {
+                std::this_thread::sleep_for(duration);
+                return;
+            }
+
+            // Negative due time = relative, in 100ns units.
+            LARGE_INTEGER due{};
+            due.QuadPart = -static_cast<LONGLONG>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / 100);
+            if (SetWaitableTimer(handle, &due, 0, nullptr, nullptr, FALSE))
+                WaitForSingleObject(handle, INFINITE);
+        }
+#else
+        Timer() = default;
+
+        void SleepFor(Clock::duration duration)
+        {
+            std::this_thread::sleep_for(duration);
+        }
+#endif
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        bool Precise() const { return precise; }
+
+    private:
+#if defined(_WIN32)
+        HANDLE handle = nullptr;
+        bool precise = false;
+#else
+        bool precise = true;
+#endif
+    };
+
+    class Pacer
+    {
+    public:
+        // 0 or less disables the cap.
+        void SetTarget(double fps)
+        {
+            period = fps > 0.0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps)) : Clock::duration::zero();
+            spinWindow = timer.Precise() ? kSpinWindowPrecise : kSpinWindowCoarse;
+            deadline = {};
+        }
+
+        bool Enabled() const { return period > Clock::duration::zero(); }
+        Clock::duration Period() const { return period; }
+        bool PreciseTimer() const { return timer.Precise(); }
+
+        // Blocks until the current frame's deadline and returns how late it woke up.
+        Clock::duration Wait()
+        {
+            if (!Enabled())
+                return Clock::duration::zero();
+
+            auto now = Clock::now();
+            if (deadline == Clock::time_point{}) {
+                deadline = now + period;
+                return Clock::duration::zero();
+            }
+
+            if (deadline - now > spinWindow)
+                timer.SleepFor(deadline - now - spinWindow);
+            while ((now = Clock::now()) < deadline)
+                FRAMELIMITER_PAUSE();
+
+            // The next deadline follows from this one rather than from when we woke, so wake-up
+            // error doesn't accumulate. After a hitch longer than a frame, start over from now
+            // instead of running frames back to back to catch up.
+            auto late = now - deadline;
+            if (late > period)
+                deadline = now + period;
+            else
+                deadline += period;
+            return late;
+        }
+
+    private:
+        Timer timer;
+        Clock::duration period = Clock::duration::zero();
+        Clock::duration spinWindow = kSpinWindowPrecise;
+        Clock::time_point deadline{};
+    };
+}
@@ -1,4 +1,6 @@
 #include "stdafx.h"
+#include "pe.hpp"
+#include "scanner.hpp"
 
 namespace Memory
 {
@@ -19,113 +21,166 @@ namespace Memory
         VirtualProtect((LPVOID)address, numBytes, oldProtect, &oldProtect);
     }
 
-    std::vector<int> pattern_to_byte(const char* pattern)
+    // Parsed module headers, built once per module.
+    const PE::ModuleInfo& GetModuleInfo(void* module)
     {
-        auto bytes = std::vector<int>{};
-        auto start = const_cast<char*>(pattern);
-        auto end = const_cast<char*>(pattern) + strlen(pattern);
+        static std::mutex mutex;
+        static std::map<void*, PE::ModuleInfo> modules;
+
+        std::scoped_lock lock(mutex);
+        auto info = modules.find(module);
+        // The loader has already checked a loaded module's headers, so there's no size to hold them to.
+        if (info == modules.end())
+            info = modules.emplace(module, PE::Parse(reinterpret_cast<std::uint8_t*>(module), SIZE_MAX).value_or(PE::ModuleInfo{})).first;
+        return info->second;
+    }
 
-        for (auto current = start; current < end; ++current) {
-            if (*current == '?') {
-                ++current;
-                if (*current == '?')
-                    ++current;
-                bytes.push_back(-1);
-            }
-            else {
-                bytes.push_back(strtoul(current, &current, 16));
+    // Appends the committed, readable, non-guard parts of [start, start + size) to regions.
+    void AppendReadableRanges(const std::uint8_t* start, std::size_t size, std::vector<Scanner::Region>& regions)
+    {
+        constexpr DWORD readable = PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+        const std::uint8_t* end = start + size;
+
+        for (const std::uint8_t* address = start; address < end; ) {
+            MEMORY_BASIC_INFORMATION mbi{};
+            if (!VirtualQuery(address, &mbi, sizeof(mbi)))
+                break;
+
+            const std::uint8_t* rangeEnd = std::min(end, reinterpret_cast<const std::uint8_t*>(mbi.BaseAddress) + mbi.RegionSize);
+            if (mbi.State == MEM_COMMIT && (mbi.Protect & readable) && !(mbi.Protect & PAGE_GUARD)) {
+                if (!regions.empty() && regions.back().Data + regions.back().Size == address)
+                    regions.back().Size += rangeEnd - address;
+                else
+                    regions.push_back({ address, static_cast<std::size_t>(rangeEnd - address) });
             }
+            address = rangeEnd;
         }
-        return bytes;
     }
 
-    std::uint8_t* PatternScan(void* module, const char* signature) 
+    // Memory to scan for signatures: every executable section by default, or only the named sections.
+    std::vector<Scanner::Region> ScanRegions(void* module, const std::vector<std::string_view>& sections = {})
     {
-        auto dosHeader = (PIMAGE_DOS_HEADER)module;
-        auto ntHeaders = (PIMAGE_NT_HEADERS)((std::uint8_t*)module + dosHeader->e_lfanew);
+        const auto& info = GetModuleInfo(module);
+        std::vector<Scanner::Region> regions;
 
-        auto sizeOfImage = ntHeaders->OptionalHeader.SizeOfImage;
-        auto patternBytes = pattern_to_byte(signature);
-        auto scanBytes = reinterpret_cast<std::uint8_t*>(module);
+        for (const auto& section : info.Sections) {
+            bool wanted = sections.empty() ? section.Executable() : std::find(sections.begin(), sections.end(), section.Name) != sections.end();
+            if (wanted)
+                AppendReadableRanges(info.Base + section.VirtualAddress, section.VirtualSize, regions);
+        }
 
-        auto s = patternBytes.size();
-        auto d = patternBytes.data();
+        return regions;
+    }
 
-        for (auto i = 0ul; i < sizeOfImage - s; ++i) {
-            bool found = true;
-            for (auto j = 0ul; j < s; ++j) {
-                if (scanBytes[i + j] != d[j] && d[j] != -1) {
-                    found = false;
-                    break;
-                }
-            }
-            if (found) {
-                return &scanBytes[i];
-            }
+    std::uint8_t* PatternScan(void* module, const Scanner::Pattern& pattern, const std::vector<std::string_view>& sections = {})
+    {
+        return const_cast<std::uint8_t*>(Scanner::FindFirstParallel(ScanRegions(module, sections), pattern));
+    }
+
+    std::uint8_t* PatternScan(void* module, const char* signature, const std::vector<std::string_view>& sections = {}) 
+    {
+        auto pattern = Scanner::Parse(signature);
+        return PatternScan(module, pattern, sections);
+    }
+
+    std::vector<std::uint8_t*> PatternScanAll(void* module, const Scanner::Pattern& pattern, const std::vector<std::string_view>& sections = {})
+    {
+        std::vector<std::uint8_t*> results;
+        for (const std::uint8_t* match : Scanner::FindAllParallel(ScanRegions(module, sections), pattern))
+            results.push_back(const_cast<std::uint8_t*>(match));
+    
+        return results;
+    }
+
+    std::vector<std::uint8_t*> PatternScanAll(void* module, const char* signature, const std::vector<std::string_view>& sections = {})
+    {
+        auto pattern = Scanner::Parse(signature);
+        return PatternScanAll(module, pattern, sections);
+    }
+
+    // Resolves every signature in one pass over the regions. Results come back in the same order as patterns.
+    std::vector<std::vector<std::uint8_t*>> BatchPatternScan(const std::vector<Scanner::Region>& regions, const std::vector<std::pair<Scanner::Pattern, Scanner::Mode>>& patterns)
+    {
+        auto multi = Scanner::BuildMultiPattern(patterns);
+        std::vector<std::vector<std::uint8_t*>> results;
+        for (const auto& matches : Scanner::ScanMultiParallel(multi, regions)) {
+            auto& result = results.emplace_back();
+            for (const std::uint8_t* match : matches)
+                result.push_back(const_cast<std::uint8_t*>(match));
         }
 
-        return nullptr;
+        return results;
+    }
+
+    std::vector<std::vector<std::uint8_t*>> BatchPatternScan(const std::vector<Scanner::Region>& regions, const std::vector<std::pair<const char*, Scanner::Mode>>& signatures)
+    {
+        std::vector<Scanner::ParsedPattern> parsed;
+        for (const auto& [signature, mode] : signatures)
+            parsed.push_back(Scanner::Parse(signature));
+
+        std::vector<std::pair<Scanner::Pattern, Scanner::Mode>> patterns;
+        for (std::size_t i = 0; i < signatures.size(); ++i)
+            patterns.emplace_back(parsed[i], signatures[i].second);
+
+        return BatchPatternScan(regions, patterns);
+    }
+
+    std::vector<std::vector<std::uint8_t*>> BatchPatternScan(void* module, const std::vector<std::pair<const char*, Scanner::Mode>>& signatures, const std::vector<std::string_view>& sections = {})
+    {
+        return BatchPatternScan(ScanRegions(module, sections), signatures);
     }
 
     std::uint8_t* MultiPatternScan(void* module, const std::vector<const char*>& signatures) 
     { 
-        for (const auto& signature : signatures) 
+        std::vector<std::pair<const char*, Scanner::Mode>> batch;
+        for (const auto& signature : signatures)
+            batch.emplace_back(signature, Scanner::Mode::First);
+
+        for (const auto& result : BatchPatternScan(module, batch)) 
         {
-            std::uint8_t* result = PatternScan(module, signature);
-            if (result)
-                return result;
+            if (!result.empty())
+                return result.front();
         }
         return nullptr;
     }
 
-    std::vector<std::uint8_t*> PatternScanAll(void* module, const char* signature)
+    std::vector<std::uint8_t*> MultiPatternScanAll(void* module, const std::vector<const char*>& signatures) 
     {
-        auto dosHeader = (PIMAGE_DOS_HEADER)module;
-        auto ntHeaders = (PIMAGE_NT_HEADERS)((std::uint8_t*)module + dosHeader->e_lfanew);
-    
-        auto sizeOfImage = ntHeaders->OptionalHeader.SizeOfImage;
-        auto patternBytes = pattern_to_byte(signature);
-        auto scanBytes = reinterpret_cast<std::uint8_t*>(module);
-    
-        auto s = patternBytes.size();
-        auto d = patternBytes.data();
-    
+        std::vector<std::pair<const char*, Scanner::Mode>> batch;
+        for (const auto& signature : signatures)
+            batch.emplace_back(signature, Scanner::Mode::All);
+
         std::vector<std::uint8_t*> results;
-    
-        for (auto i = 0ul; i < sizeOfImage - s; ++i) {
-            bool found = true;
-            for (auto j = 0ul; j < s; ++j) {
-                if (scanBytes[i + j] != d[j] && d[j] != -1) {
-                    found = false;
-                    break;
-                }
-            }
-            if (found) {
-                results.push_back(&scanBytes[i]);
-            }
-        }
-    
+        for (const auto& matches : BatchPatternScan(module, batch))
+            results.insert(results.end(), matches.begin(), matches.end());
+
         return results;
     }
 
-    std::vector<std::uint8_t*> MultiPatternScanAll(void* module, const std::vector<const char*>& signatures) 
+    // Re-matches a signature at previously resolved RVAs. Returns the addresses that still match and lie
+    // inside regions, in the order given.
+    std::vector<std::uint8_t*> VerifyPattern(void* module, const std::vector<Scanner::Region>& regions, const Scanner::Pattern& pattern, const std::vector<std::uint32_t>& rvas)
     {
-        std::vector<std::uint8_t*> results;
-        
-        for (const auto& signature : signatures) 
-        {
-            auto matches = PatternScanAll(module, signature);
-            results.insert(results.end(), matches.begin(), matches.end());
+        auto* base = reinterpret_cast<std::uint8_t*>(module);
+
+        std::vector<std::uint8_t*> verified;
+        for (std::uint32_t rva : rvas) {
+            std::uint8_t* address = base + rva;
+            for (const auto& region : regions) {
+                const std::uint8_t* end = region.Data + region.Size;
+                if (address >= region.Data && address < end && static_cast<std::size_t>(end - address) >= pattern.Size) {
+                    if (Scanner::MatchesAt(address, end, pattern))
+                        verified.push_back(address);
+                    break;
+                }
+            }
         }
-
-        return results;
+        return verified;
     }
 
     std::uint32_t ModuleTimestamp(void* module)
     {
-        auto dosHeader = (PIMAGE_DOS_HEADER)module;
-        auto ntHeaders = (PIMAGE_NT_HEADERS)((std::uint8_t*)module + dosHeader->e_lfanew);
-        return ntHeaders->FileHeader.TimeDateStamp;
+        return GetModuleInfo(module).Timestamp;
     }
 
     std::uint8_t* GetAbsolute(std::uint8_t* address) noexcept
@@ -142,17 +197,14 @@ namespace Memory
     BOOL HookIAT(HMODULE callerModule, char const* targetModule, const void* targetFunction, void* detourFunction)
     {
         auto* base = (uint8_t*)callerModule;
-        const auto* dos_header = (IMAGE_DOS_HEADER*)base;
-        const auto nt_headers = (IMAGE_NT_HEADERS*)(base + dos_header->e_lfanew);
-        const auto* imports = (IMAGE_IMPORT_DESCRIPTOR*)(base + nt_headers->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_IMPORT].VirtualAddress);
+        const auto& info = GetModuleInfo(callerModule);
 
-        for (int i = 0; imports[i].Characteristics; i++)
+        for (const auto& imported : info.Imports)
         {
-            const char* name = (const char*)(base + imports[i].Name);
-            if (lstrcmpiA(name, targetModule) != 0)
+            if (lstrcmpiA(imported.Module.c_str(), targetModule) != 0)
                 continue;
 
-            void** thunk = (void**)(base + imports[i].FirstThunk);
+            void** thunk = (void**)(base + imported.FirstThunk);
 
             for (; *thunk; thunk++)
             {
@@ -0,0 +1,254 @@
+#pragma once
+
+#include "callbacks.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// Capture of callback inputs and outputs, for replaying them through Callbacks::Run() outside the game.
+//
+// File layout (little endian, no padding between items):
+//   FileHeader
+//   Record*:  RecordHeader, context before (sizeof(SafetyHookContext) bytes), uint64 mask of the
+//             context words that changed, the new value of each changed word, then per span:
+//             SpanHeader, bytes before, bytes after
+namespace HookCapture
+{
+    constexpr char kMagic[8] = { 'M', 'G', 'S', 'V', 'H', 'C', '0', '1' };
+    constexpr std::size_t kContextWords = sizeof(SafetyHookContext) / sizeof(std::uint64_t);
+    static_assert(sizeof(SafetyHookContext) % sizeof(std::uint64_t) == 0 && kContextWords <= 64);
+
+    enum Flags : std::uint8_t
+    {
+        MovieBefore = 1 << 0,
+        MovieAfter = 1 << 1,
+    };
+
+#pragma pack(push, 1)
+    struct FileHeader
+    {
+        char Magic[8];
+        std::uint8_t Game;
+        std::uint8_t Reserved[3];
+        std::int32_t TerrainDistance;
+        float ModelDistance;
+        float GrassDistance;
+        std::uint32_t HUDWidthOffset;
+        std::uint32_t HUDHeightOffset;
+        std::uint32_t HUDScaleOffset;
+    };
+
+    struct RecordHeader
+    {
+        std::uint16_t Hook;
+        std::uint8_t SpanCount;
+        std::uint8_t Flags;
+        std::int32_t ResX;
+        std::int32_t ResY;
+    };
+
+    struct SpanHeader
+    {
+        std::uint16_t Register;
+        std::int32_t Offset;
+        std::uint8_t Size;
+    };
+#pragma pack(pop)
+
+    struct Span
+    {
+        Callbacks::Span Where;
+        std::vector<std::uint8_t> Before;
+        std::vector<std::uint8_t> After;
+    };
+
+    struct Record
+    {
+        RecordHeader Header;
+        SafetyHookContext Before;
+        SafetyHookContext After;
+        std::vector<Span> Spans;
+    };
+
+    inline std::uintptr_t& Register(SafetyHookContext& ctx, std::uint16_t offset)
+    {
+        return *reinterpret_cast<std::uintptr_t*>(reinterpret_cast<std::uint8_t*>(&ctx) + offset);
+    }
+
+    inline void Append(std::vector<std::uint8_t>& out, const void* data, std::size_t size)
+    {
+        auto bytes = static_cast<const std::uint8_t*>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    }
+
+    inline void Encode(std::vector<std::uint8_t>& out, const RecordHeader& header, const SafetyHookContext& before, const SafetyHookContext& after,
+                       const Callbacks::Span* spans, const std::uint8_t* spanBefore, const std::uint8_t* spanAfter)
+    {
+        std::array<std::uint64_t, kContextWords> wordsBefore, wordsAfter;
+        std::memcpy(wordsBefore.data(), &before, sizeof(before));
+        std::memcpy(wordsAfter.data(), &after, sizeof(after));
+        std::uint64_t changed = 0;
+        for (std::size_t i = 0; i < kContextWords; ++i) {
+            if (wordsBefore[i] != wordsAfter[i])
+                changed |= std::uint64_t(1) << i;
+        }
+
+        Append(out, &header, sizeof(header));
+        Append(out, &before, sizeof(before));
+        Append(out, &changed, sizeof(changed));
+        for (std::size_t i = 0; i < kContextWords; ++i) {
+            if (changed & (std::uint64_t(1) << i))
+                Append(out, &wordsAfter[i], sizeof(std::uint64_t));
+        }
+        for (std::size_t i = 0; i < header.SpanCount; ++i) {
+            SpanHeader span{ spans[i].Register, spans[i].Offset, spans[i].Size };
+            Append(out, &span, sizeof(span));
+            Append(out, spanBefore, spans[i].Size);
+            Append(out, spanAfter, spans[i].Size);
+            spanBefore += spans[i].Size;
+            spanAfter += spans[i].Size;
+        }
+    }
+
+    // Reads a whole capture file. Returns nothing if the header is wrong, stops at a truncated record.
+    inline std::optional<std::pair<FileHeader, std::vector<Record>>> Load(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        FileHeader header{};
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.Magic, kMagic, sizeof(kMagic)) != 0)
+            return std::nullopt;
+
+        std::vector<Record> records;
+        for (;;) {
+            Record record{};
+            std::uint64_t changed = 0;
+            if (!file.read(reinterpret_cast<char*>(&record.Header), sizeof(record.Header)) ||
+                !file.read(reinterpret_cast<char*>(&record.Before), sizeof(record.Before)) ||
+                !file.read(reinterpret_cast<char*>(&changed), sizeof(changed)))
+                break;
+            if (record.Header.Hook >= static_cast<std::uint16_t>(Callbacks::Id::Count) || record.Header.SpanCount > Callbacks::kMaxSpans)
+                break;
+
+            std::array<std::uint64_t, kContextWords> words;
+            std::memcpy(words.data(), &record.Before, sizeof(record.Before));
+            for (std::size_t i = 0; i < kContextWords; ++i) {
+                if (changed & (std::uint64_t(1) << i))
+                    file.read(reinterpret_cast<char*>(&words[i]), sizeof(std::uint64_t));
+            }
+            std::memcpy(&record.After, words.data(), sizeof(record.After));
+
+            for (std::size_t i = 0; i < record.Header.SpanCount; ++i) {
+                SpanHeader span{};
+                file.read(reinterpret_cast<char*>(&span), sizeof(span));
+                Span loaded{ { span.Register, span.Offset, span.Size }, std::vector<std::uint8_t>(span.Size), std::vector<std::uint8_t>(span.Size) };
+                file.read(reinterpret_cast<char*>(loaded.Before.data()), span.Size);
+                file.read(reinterpret_cast<char*>(loaded.After.data()), span.Size);
+                record.Spans.push_back(std::move(loaded));
+            }
+            if (!file)
+                break;
+            records.push_back(std::move(record));
+        }
+        return std::pair{ header, std::move(records) };
+    }
+
+    // Collects records from the hooks and writes them out from its own thread once a second.
+    class Writer
+    {
+    public:
+        bool Open(const std::filesystem::path& path, const FileHeader& header, std::uint32_t maxPerHook)
+        {
+            file.open(path, std::ios::binary | std::ios::trunc);
+            if (!file)
+                return false;
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            limit = maxPerHook;
+
+            std::thread([this] {
+                std::vector<std::uint8_t> pending;
+                for (;;) {
+                    std::this_thread::sleep_for(std::chrono::seconds(1));
+                    {
+                        std::scoped_lock lock(mutex);
+                        pending.swap(buffer);
+                    }
+                    if (!pending.empty()) {
+                        file.write(reinterpret_cast<const char*>(pending.data()), pending.size());
+                        file.flush();
+                        pending.clear();
+                    }
+                }
+            }).detach();
+            return true;
+        }
+
+        // Runs the callback, recording it if this hook still has quota left.
+        void Run(Callbacks::Id id, SafetyHookContext& ctx)
+        {
+            auto& count = counts[static_cast<std::size_t>(id)];
+            if (count.load(std::memory_order_relaxed) >= limit || count.fetch_add(1, std::memory_order_relaxed) >= limit) {
+                Callbacks::Run(id, ctx);
+                return;
+            }
+
+            const auto& scale = Callbacks::renderScale.Load();
+            RecordHeader header{ static_cast<std::uint16_t>(id), 0, 0, scale.ResX, scale.ResY };
+            if (Callbacks::bIsMoviePlaying.load(std::memory_order_relaxed))
+                header.Flags |= MovieBefore;
+
+            Callbacks::Span spans[Callbacks::kMaxSpans];
+            header.SpanCount = static_cast<std::uint8_t>(Callbacks::Spans(id, ctx, spans));
+            std::uint8_t before[Callbacks::kMaxSpans * 8];
+            std::uint8_t after[Callbacks::kMaxSpans * 8];
+            Copy(ctx, spans, header.SpanCount, before);
+
+            SafetyHookContext original = ctx;
+            Callbacks::Run(id, ctx);
+
+            Copy(ctx, spans, header.SpanCount, after);
+            if (Callbacks::bIsMoviePlaying.load(std::memory_order_relaxed))
+                header.Flags |= MovieAfter;
+
+            std::scoped_lock lock(mutex);
+            Encode(buffer, header, original, ctx, spans, before, after);
+        }
+
+    private:
+        std::ofstream file;
+        std::mutex mutex;
+        std::vector<std::uint8_t> buffer;
+        std::uint32_t limit = 0;
+        std::array<std::atomic<std::uint32_t>, static_cast<std::size_t>(Callbacks::Id::Count)> counts{};
+
+        static void Copy(SafetyHookContext& ctx, const Callbacks::Span* spans, std::size_t count, std::uint8_t* out)
+        {
+            for (std::size_t i = 0; i < count; ++i) {
+                std::memcpy(out, reinterpret_cast<const void*>(Register(ctx, spans[i].Register) + spans[i].Offset), spans[i].Size);
+                out += spans[i].Size;
+            }
+        }
+    };
+
+    inline std::atomic<Writer*> active{ nullptr };
+
+    // What the hooks call: a straight call to the callback unless a capture is running.
+    template <Callbacks::Id id>
+    void Run(SafetyHookContext& ctx)
+    {
+        if (Writer* writer = active.load(std::memory_order_relaxed)) [[unlikely]]
+            writer->Run(id, ctx);
+        else
+            Callbacks::Run(id, ctx);
+    }
+}
@@ -0,0 +1,349 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include "codecave.hpp"
+#include "profiler.hpp"
+#include "telemetry.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <thread>
+
+#include <safetyhook.hpp>
+#include <spdlog/spdlog.h>
+
+namespace Hooks
+{
+    // How often a hook is expected to run. Hooks are laid out in the arena hottest first, so the hot
+    // ones share cache lines and pages instead of sitting between cold ones.
+    enum class Heat : std::uint8_t
+    {
+        Hot,        // Many times per frame (HUD elements)
+        Warm,       // About once per frame
+        Cold,       // Resolution changes, movies, anything not listed
+    };
+
+    struct HeatRule
+    {
+        const char* Name;
+        Heat Is;
+    };
+
+    namespace Detail
+    {
+        // Held while a transaction creates and commits its hooks, and while a group switches, so a
+        // group never sees a hook that's half created or not yet committed.
+        inline std::mutex mutex;
+    }
+
+    // Mid hooks and code caves are queued while the fixes run, then created hottest first from one
+    // arena and patched in by Commit() under a single trap cycle. A hook failing to create or patch
+    // rolls back the whole batch.
+    class Transaction
+    {
+    public:
+        explicit Transaction(std::span<const HeatRule> heat = {}) : heat(heat) {}
+
+        // destination is a captureless lambda, so it can be wrapped per hook for frame telemetry
+        // and, in profiling builds, the profiler.
+        template <typename Fn>
+        void Mid(const char* name, SafetyHookMid& hook, std::uint8_t* target, Fn destination)
+        {
+            Mid(name, hook, target, safetyhook::reg::all, destination);
+        }
+
+        // For hot hooks: the stub only saves the registers the callback reads or writes (see
+        // safetyhook::make_lean_mid_stub), the rest of the context is garbage.
+        template <typename Fn>
+        void Mid(const char* name, SafetyHookMid& hook, std::uint8_t* target, safetyhook::MidRegisters registers, Fn destination)
+        {
+            auto wrapped = Profiler::Wrap<SafetyHookContext>(Telemetry::Wrap<SafetyHookContext>(destination, name), name);
+            Pending entry{ name, HeatOf(name), target };
+            entry.Hook = &hook;
+            entry.Registers = registers;
+            entry.Destination = static_cast<safetyhook::MidHookFn>(wrapped);
+            pending.push_back(entry);
+        }
+
+        // For hooks that only do xmm *= render scale value: a code cave instead of a mid hook. Caves
+        // can't mark themselves as fired, so hitch reports list them as not tracked.
+        void Scale(const char* name, CodeCave::Scale& cave, std::uint8_t* target, std::uint8_t xmm, float RenderScale::Snapshot::* value, bool widerOnly = true)
+        {
+            Telemetry::RegisterUntracked(name);
+            Pending entry{ name, HeatOf(name), target };
+            entry.Cave = &cave;
+            entry.Xmm = xmm;
+            entry.Value = value;
+            entry.WiderOnly = widerOnly;
+            pending.push_back(entry);
+        }
+
+        bool Commit()
+        {
+            std::scoped_lock lock(Detail::mutex);
+            Create();
+            if (failed) {
+                spdlog::error("Hooks: {:d} hook(s) failed to create, rolling back {:d} prepared hooks.", failed, hooks.size() + caves.size());
+                Rollback();
+                return false;
+            }
+
+            auto commitStart = std::chrono::steady_clock::now();
+            auto result = transaction.commit();
+            auto commitTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - commitStart).count();
+
+            if (!result) {
+                spdlog::error("Hooks: Commit failed (error {:d}), rolled back {:d} hooks.", (int)result.error().type, hooks.size() + caves.size());
+                Rollback();
+                return false;
+            }
+
+            spdlog::info("Hooks: Enabled {:d} hooks ({:d} code caves) in one transaction in {:.3f}ms.", hooks.size() + caves.size(), caves.size(), commitTime);
+            hooks.clear();
+            caves.clear();
+            return true;
+        }
+
+    private:
+        // Room for every stub, cave and trampoline, a single allocation granule on Windows.
+        static constexpr std::size_t kArenaSize = 64 * 1024;
+        static constexpr const char* kHeatNames[] = { "hot", "warm", "cold" };
+
+        struct Pending
+        {
+            const char* Name;
+            Heat Is;
+            std::uint8_t* Target;
+            SafetyHookMid* Hook = nullptr;
+            safetyhook::MidRegisters Registers = safetyhook::reg::all;
+            safetyhook::MidHookFn Destination = nullptr;
+            CodeCave::Scale* Cave = nullptr;
+            std::uint8_t Xmm = 0;
+            float RenderScale::Snapshot::* Value = nullptr;
+            bool WiderOnly = true;
+        };
+
+        std::span<const HeatRule> heat;
+        std::shared_ptr<safetyhook::Allocator> arena;
+        std::uint8_t* arenaStart = nullptr;
+        std::vector<Pending> pending;
+        std::vector<SafetyHookMid*> hooks;
+        std::vector<CodeCave::Scale*> caves;
+        safetyhook::Transaction transaction;
+        int failed = 0;
+
+        Heat HeatOf(const char* name) const
+        {
+            for (const auto& rule : heat) {
+                if (std::string_view(rule.Name) == name)
+                    return rule.Is;
+            }
+            return Heat::Cold;
+        }
+
+        // One block near the hooked code, reserved the first time there's something to put in it.
+        void ReserveArena()
+        {
+            auto [lowest, highest] = std::minmax_element(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) { return a.Target < b.Target; });
+            auto reserved = safetyhook::Allocator::create_reserved({ lowest->Target, highest->Target }, kArenaSize);
+            if (!reserved) {
+                spdlog::error("Hook Arena: Failed to reserve {:d}KB (error {:d}), using the shared allocator.", kArenaSize / 1024, (int)reserved.error());
+                arena = safetyhook::Allocator::global();
+                return;
+            }
+            arena = std::move(*reserved);
+            arenaStart = arena->blocks().front().address;
+            spdlog::info("Hook Arena: Reserved {:d}KB at 0x{:x}.", kArenaSize / 1024, (uintptr_t)arenaStart);
+        }
+
+        std::string Where(const safetyhook::Allocation& allocation) const
+        {
+            char where[24];
+            if (arenaStart && allocation.data() >= arenaStart && allocation.data() < arenaStart + kArenaSize)
+                std::snprintf(where, sizeof(where), "+0x%04zx", static_cast<std::size_t>(allocation.data() - arenaStart));
+            else
+                std::snprintf(where, sizeof(where), "0x%llx", static_cast<unsigned long long>(allocation.address()));
+            return where;
+        }
+
+        void Create()
+        {
+            if (pending.empty())
+                return;
+            if (!arena)
+                ReserveArena();
+
+            std::stable_sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) { return a.Is < b.Is; });
+            for (const auto& entry : pending) {
+                if (entry.Hook) {
+                    auto result = safetyhook::MidHook::create_lean(arena, entry.Target, entry.Registers, entry.Destination, safetyhook::MidHook::StartDisabled);
+                    if (!result) {
+                        spdlog::error("Hooks: {:s}: Failed to create mid hook at 0x{:x} (error {:d}).", entry.Name, (uintptr_t)entry.Target, (int)result.error().type);
+                        failed++;
+                        continue;
+                    }
+
+                    *entry.Hook = std::move(*result);
+                    hooks.push_back(entry.Hook);
+                    transaction.add(*entry.Hook);
+                    spdlog::info("Hook Arena: {:s} ({:s}): stub {:s} ({:d} bytes), trampoline {:s} ({:d} bytes)", entry.Name, kHeatNames[static_cast<int>(entry.Is)],
+                        Where(entry.Hook->stub()), entry.Hook->stub().size(), Where(entry.Hook->trampoline()), entry.Hook->trampoline().size());
+                }
+                else {
+                    auto result = entry.Cave->Create(arena, entry.Target, entry.Xmm, entry.Value, entry.WiderOnly);
+                    if (!result) {
+                        spdlog::error("Hooks: {:s}: Failed to create code cave at 0x{:x} (error {:d}).", entry.Name, (uintptr_t)entry.Target, (int)result.error().type);
+                        failed++;
+                        continue;
+                    }
+
+                    caves.push_back(entry.Cave);
+                    transaction.add(entry.Cave->Hook());
+                    spdlog::info("Hook Arena: {:s} ({:s}): cave {:s} ({:d} bytes), trampoline {:s} ({:d} bytes)", entry.Name, kHeatNames[static_cast<int>(entry.Is)],
+                        Where(entry.Cave->Cave()), entry.Cave->Cave().size(), Where(entry.Cave->Hook().trampoline()), entry.Cave->Hook().trampoline().size());
+                }
+            }
+            pending.clear();
+
+            if (arenaStart) {
+                auto blocks = arena->blocks();
+                std::size_t used = blocks.front().size - blocks.front().free;
+                spdlog::info("Hook Arena: {:d} of {:d} bytes used, {:d} page(s), {:d} overflow block(s).", used, blocks.front().size, (used + 4095) / 4096, blocks.size() - 1);
+            }
+        }
+
+        void Rollback()
+        {
+            for (auto* hook : hooks)
+                hook->reset();
+            for (auto* cave : caves)
+                cave->Reset();
+            hooks.clear();
+            caves.clear();
+            transaction = {};
+            failed = 0;
+        }
+    };
+
+    // Whether a group follows the aspect ratio or is held on or off.
+    enum class Mode : std::uint8_t
+    {
+        Auto,
+        On,
+        Off,
+    };
+
+    // Hooks that are switched off (original code restored) and back on together at runtime. Hooks
+    // can be added before they're created. Until a transaction has committed them they're skipped,
+    // Detail::mutex keeps Set() from running in the middle of a commit.
+    class Group
+    {
+    public:
+        explicit Group(const char* name) : name(name) {}
+
+        void Add(SafetyHookMid& hook)
+        {
+            std::scoped_lock lock(Detail::mutex);
+            hooks.push_back(&hook);
+        }
+
+        void Add(CodeCave::Scale& cave)
+        {
+            std::scoped_lock lock(Detail::mutex);
+            caves.push_back(&cave);
+        }
+
+        // Enables or disables every hook in the group under a single trap cycle. Hooks already in that
+        // state are left alone, so this can be repeated after a commit enabled new hooks.
+        void Set(bool enable)
+        {
+            std::scoped_lock lock(Detail::mutex);
+            safetyhook::Transaction transaction;
+            std::size_t changing = 0;
+            for (auto* hook : hooks) {
+                if (*hook && hook->enabled() != enable) {
+                    transaction.add(*hook);
+                    changing++;
+                }
+            }
+            for (auto* cave : caves) {
+                if (cave->Hook() && cave->Hook().enabled() != enable) {
+                    transaction.add(cave->Hook());
+                    changing++;
+                }
+            }
+            if (!changing)
+                return;
+
+            auto start = std::chrono::steady_clock::now();
+            if (enable) {
+                if (auto result = transaction.commit(); !result) {
+                    spdlog::error("Hook Groups: {:s}: Failed to enable {:d} hooks (error {:d}).", name, changing, (int)result.error().type);
+                    return;
+                }
+            }
+            else {
+                transaction.revert();
+            }
+            auto time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            spdlog::info("Hook Groups: {:s}: {:s} {:d} hooks in {:.3f}ms.", name, enable ? "Enabled" : "Disabled", changing, time);
+        }
+
+    private:
+        const char* name;
+        std::vector<SafetyHookMid*> hooks;
+        std::vector<CodeCave::Scale*> caves;
+    };
+
+    // Runs group switches on a thread of its own, so a hook asking for one never waits on the trap
+    // pass or the log. Requests made while a switch runs are folded into one more run. The thread is
+    // started by the first request and never torn down, like the scanner's workers.
+    class Switcher
+    {
+    public:
+        explicit Switcher(void (*apply)()) : apply(apply) {}
+
+        void Request()
+        {
+            {
+                std::scoped_lock lock(state->Mutex);
+                state->Pending = true;
+                if (!state->Started) {
+                    state->Started = true;
+                    std::thread(Loop, state, apply).detach();
+                }
+            }
+            state->Wake.notify_one();
+        }
+
+    private:
+        // Never freed, the thread is still waiting on it when the process exits.
+        struct State
+        {
+            std::mutex Mutex;
+            std::condition_variable Wake;
+            bool Pending = false;
+            bool Started = false;
+        };
+
+        static void Loop(State* state, void (*apply)())
+        {
+            std::unique_lock lock(state->Mutex);
+            for (;;) {
+                state->Wake.wait(lock, [state] { return state->Pending; });
+                state->Pending = false;
+                lock.unlock();
+                apply();
+                lock.lock();
+            }
+        }
+
+        void (*apply)();
+        State* state = new State();
+    };
+}
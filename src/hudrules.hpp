@@ -0,0 +1,254 @@
+#pragma once
+
+#include "signatures.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Rules for the HUD backgrounds hook, matched on the element's (width, height) in UI units.
+namespace HUDRules
+{
+    enum class Action : std::uint8_t
+    {
+        Span,           // Multiply xmm0 (the element's width scale) by the aspect multiplier
+        ScopeScale,     // Write the overall width scale at +0x740
+    };
+
+    // An exact size, or an open range (Min, Max) for elements whose size drifts with resolution.
+    struct Range
+    {
+        float Min;
+        float Max;
+        bool Exact;
+
+        constexpr bool Contains(float value) const
+        {
+            return Exact ? value == Min : (value > Min && value < Max);
+        }
+    };
+
+    using Signatures::InGZ;
+    using Signatures::InTPP;
+    using Signatures::InBoth;
+
+    struct Rule
+    {
+        std::string Name;
+        std::uint8_t Games;
+        Range Width;
+        Range Height;
+        Action Do;
+    };
+
+    constexpr bool AppliesTo(const Rule& rule, Game game)
+    {
+        return (game == Game::GZ && (rule.Games & InGZ)) || (game == Game::TPP && (rule.Games & InTPP));
+    }
+
+    constexpr Range Exactly(float value) { return { value, value, true }; }
+    constexpr Range Between(float min, float max) { return { min, max, false }; }
+
+    // Built-ins run in both games like the original checks did, the game noted is where each was seen.
+    inline const Rule kDefaultRules[] = {
+        { "ui_sys_cmn_bg",          InBoth, Exactly(2048.00f),          Exactly(1152.00f),          Action::Span },
+        { "Cutscene skip BG",       InBoth, Exactly(2000.00f),          Exactly(1125.00f),          Action::Span },
+        { "Loadout BG",             InBoth, Exactly(1400.00f),          Exactly(1400.00f),          Action::Span },          // TPP
+        { "Mission failed BG 1",    InBoth, Exactly(1500.00f),          Exactly(1500.00f),          Action::Span },
+        { "Mission failed BG 2",    InBoth, Exactly(2000.00f),          Exactly(2000.00f),          Action::Span },
+        { "Mission failed BG 3",    InBoth, Between(1882.00f, 1884.00f), Between(1059.00f, 1061.00f), Action::Span },
+        { "Mission failed BG 4",    InBoth, Between(1770.00f, 1772.00f), Between(995.00f, 997.00f),   Action::Span },
+        { "Scope fade",             InBoth, Exactly(1400.00f),          Exactly(1280.00f),          Action::Span },
+        { "Scope frame",            InBoth, Exactly(600.00f),           Between(1230.00f, 1231.00f), Action::Span },         // GZ
+        { "Scope frame",            InBoth, Exactly(1500.00f),          Exactly(1000.00f),          Action::ScopeScale },    // TPP
+    };
+
+    // Where the element's size lives relative to rcx.
+    struct Layout
+    {
+        std::size_t WidthOffset;
+        std::size_t HeightOffset;
+        std::size_t ScaleOffset;
+    };
+
+    constexpr Layout kLayoutGZ{ 0x30, 0x34, 0x740 };
+    constexpr Layout kLayoutTPP{ 0x40, 0x44, 0x740 };
+
+    // Ranges may span at most this many whole units, so a rule fills a bounded number of cells.
+    constexpr float kMaxRangeSpan = 64.00f;
+
+    inline std::string_view Trim(std::string_view text)
+    {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+            text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
+            text.remove_suffix(1);
+        return text;
+    }
+
+    inline std::optional<float> ParseFloat(std::string_view text)
+    {
+        float value = 0.00f;
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (error != std::errc{} || end != text.data() + text.size() || !std::isfinite(value) || value < 0.00f || value >= 65536.00f)
+            return std::nullopt;
+        return value;
+    }
+
+    inline std::optional<Range> ParseRange(std::string_view text)
+    {
+        text = Trim(text);
+        if (auto tilde = text.find('~'); tilde != std::string_view::npos) {
+            auto min = ParseFloat(Trim(text.substr(0, tilde)));
+            auto max = ParseFloat(Trim(text.substr(tilde + 1)));
+            if (!min || !max || *max <= *min || *max - *min > kMaxRangeSpan)
+                return std::nullopt;
+            return Between(*min, *max);
+        }
+        auto value = ParseFloat(text);
+        if (!value)
+            return std::nullopt;
+        return Exactly(*value);
+    }
+
+    // Parses "Game, Width, Height, Action" from an ini value, e.g. "Both, 1882~1884, 1059~1061, Span".
+    inline std::optional<Rule> ParseRule(std::string_view name, std::string_view value)
+    {
+        std::vector<std::string_view> fields;
+        while (true) {
+            auto comma = value.find(',');
+            fields.push_back(Trim(value.substr(0, comma)));
+            if (comma == std::string_view::npos)
+                break;
+            value.remove_prefix(comma + 1);
+        }
+        if (fields.size() != 4)
+            return std::nullopt;
+
+        Rule rule{ std::string(name), 0, {}, {}, Action::Span };
+        if (fields[0] == "GZ")
+            rule.Games = InGZ;
+        else if (fields[0] == "TPP")
+            rule.Games = InTPP;
+        else if (fields[0] == "Both")
+            rule.Games = InBoth;
+        else
+            return std::nullopt;
+
+        auto width = ParseRange(fields[1]);
+        auto height = ParseRange(fields[2]);
+        if (!width || !height)
+            return std::nullopt;
+        rule.Width = *width;
+        rule.Height = *height;
+
+        if (fields[3] == "Span")
+            rule.Do = Action::Span;
+        else if (fields[3] == "ScopeScale")
+            rule.Do = Action::ScopeScale;
+        else
+            return std::nullopt;
+
+        return rule;
+    }
+
+    // Open-addressed hash of whole-unit (width, height) cells. Every cell a rule's ranges touch points
+    // at that rule, so a lookup is one hash probe plus an exact check against the few rules in the cell.
+    // Built once before the hook goes live and only read afterwards.
+    class Table
+    {
+    public:
+        void Build(const std::vector<Rule>& rules, Game game)
+        {
+            // Group rules by cell first so each cell's candidates are contiguous.
+            std::vector<std::pair<std::uint32_t, std::uint16_t>> cells;
+            Rules.clear();
+            for (const auto& rule : rules) {
+                if (!AppliesTo(rule, game))
+                    continue;
+
+                auto index = static_cast<std::uint16_t>(Rules.size());
+                Rules.push_back(rule);
+                for (auto w = static_cast<std::uint32_t>(rule.Width.Min); w <= static_cast<std::uint32_t>(rule.Width.Max); ++w) {
+                    for (auto h = static_cast<std::uint32_t>(rule.Height.Min); h <= static_cast<std::uint32_t>(rule.Height.Max); ++h)
+                        cells.emplace_back(Key(w, h), index);
+                }
+            }
+            std::stable_sort(cells.begin(), cells.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+            std::size_t capacity = 16;
+            while (capacity < cells.size() * 2)
+                capacity *= 2;
+            Slots.assign(capacity, Slot{});
+            Mask = capacity - 1;
+            Candidates.clear();
+
+            for (std::size_t i = 0; i < cells.size(); ) {
+                std::uint32_t key = cells[i].first;
+                Slot slot{ key, static_cast<std::uint16_t>(Candidates.size()), 0 };
+                for (; i < cells.size() && cells[i].first == key; ++i) {
+                    Candidates.push_back(cells[i].second);
+                    slot.Count++;
+                }
+
+                std::size_t probe = Hash(key) & Mask;
+                while (Slots[probe].Count)
+                    probe = (probe + 1) & Mask;
+                Slots[probe] = slot;
+            }
+        }
+
+        const Rule* Find(float width, float height) const
+        {
+            // Also rejects NaN.
+            if (!(width >= 0.00f && width < 65536.00f && height >= 0.00f && height < 65536.00f))
+                return nullptr;
+
+            std::uint32_t key = Key(static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height));
+            for (std::size_t probe = Hash(key) & Mask; Slots[probe].Count; probe = (probe + 1) & Mask) {
+                const Slot& slot = Slots[probe];
+                if (slot.Key != key)
+                    continue;
+
+                for (std::uint16_t i = 0; i < slot.Count; ++i) {
+                    const Rule& rule = Rules[Candidates[slot.First + i]];
+                    if (rule.Width.Contains(width) && rule.Height.Contains(height))
+                        return &rule;
+                }
+                return nullptr;
+            }
+            return nullptr;
+        }
+
+        std::size_t RuleCount() const { return Rules.size(); }
+        std::size_t CellCount() const { return Candidates.size(); }
+
+    private:
+        struct Slot
+        {
+            std::uint32_t Key = 0;
+            std::uint16_t First = 0;
+            std::uint16_t Count = 0;    // 0 = empty
+        };
+
+        std::vector<Rule> Rules;
+        std::vector<Slot> Slots = std::vector<Slot>(1);
+        std::vector<std::uint16_t> Candidates;
+        std::size_t Mask = 0;
+
+        static constexpr std::uint32_t Key(std::uint32_t width, std::uint32_t height)
+        {
+            return (width << 16) | (height & 0xFFFF);
+        }
+
+        static constexpr std::size_t Hash(std::uint32_t key)
+        {
+            return (key * 0x9E3779B1u) >> 8;
+        }
+    };
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// Adjusts model and grass LOD distances between a minimum and maximum to keep frame time under a
+// target. Frames are averaged over a window. Distances drop as soon as a window goes over the target
+// and only rise after several windows in a row below the dead band under it, so they settle instead
+// of hunting back and forth.
+// Nothing here touches the game, so tools/lodsim.cpp runs the same controller against traces.
+namespace LODGovernor
+{
+    struct Settings
+    {
+        float TargetMs = 16.67f;
+        float Hysteresis = 0.10f;       // Dead band below the target, as a fraction of it
+        int WindowFrames = 60;          // Frames averaged per decision
+        int RaiseAfter = 3;             // Windows in a row under the band before raising
+        float Step = 0.10f;             // Fraction of the min-max range moved per decision
+        float MinModelDistance = 128.00f;
+        float MaxModelDistance = 512.00f;
+        float MinGrassDistance = 250.00f;
+        float MaxGrassDistance = 1000.00f;
+    };
+
+    struct Decision
+    {
+        float WindowMs;                 // Average frame time that triggered it
+        float Level;                    // 0 = min distances, 1 = max
+        float ModelDistance;
+        float GrassDistance;
+        bool Raised;
+    };
+
+    class Controller
+    {
+    public:
+        explicit Controller(const Settings& settings) : settings(settings)
+        {
+            this->settings.WindowFrames = std::max(this->settings.WindowFrames, 1);
+            this->settings.RaiseAfter = std::max(this->settings.RaiseAfter, 1);
+            this->settings.Step = std::clamp(this->settings.Step, 0.01f, 1.00f);
+        }
+
+        // Feeds one frame time, returns a decision when the distances changed.
+        std::optional<Decision> Add(float frameMs)
+        {
+            // A single hitch (loading, autosave) shouldn't be able to force a drop on its own.
+            windowSum += std::min(frameMs, settings.TargetMs * 2.00f);
+            if (++windowCount < settings.WindowFrames)
+                return std::nullopt;
+
+            float average = windowSum / static_cast<float>(windowCount);
+            windowSum = 0.00f;
+            windowCount = 0;
+
+            float previous = level;
+            if (average > settings.TargetMs) {
+                headroom = 0;
+                level = std::max(level - settings.Step, 0.00f);
+            }
+            else if (average < settings.TargetMs * (1.00f - settings.Hysteresis)) {
+                if (++headroom >= settings.RaiseAfter) {
+                    headroom = 0;
+                    level = std::min(level + settings.Step, 1.00f);
+                }
+            }
+            else {
+                headroom = 0;
+            }
+
+            if (level == previous)
+                return std::nullopt;
+            return Decision{ average, level, ModelDistance(), GrassDistance(), level > previous };
+        }
+
+        float Level() const { return level; }
+        float ModelDistance() const { return Lerp(settings.MinModelDistance, settings.MaxModelDistance); }
+        float GrassDistance() const { return Lerp(settings.MinGrassDistance, settings.MaxGrassDistance); }
+
+    private:
+        Settings settings;
+        float level = 1.00f;
+        float windowSum = 0.00f;
+        int windowCount = 0;
+        int headroom = 0;
+
+        float Lerp(float min, float max) const
+        {
+            return min + (max - min) * level;
+        }
+    };
+
+    // Hands decisions from the thread running the controller to one that logs them, so the game's
+    // thread never waits on the log. Single producer, single consumer. Decisions that don't fit are
+    // only counted.
+    class DecisionQueue
+    {
+    public:
+        static constexpr std::size_t kCapacity = 16;
+
+        void Push(const Decision& decision)
+        {
+            std::size_t position = head.load(std::memory_order_relaxed);
+            if (position - tail.load(std::memory_order_acquire) == kCapacity) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            decisions[position % kCapacity] = decision;
+            head.store(position + 1, std::memory_order_release);
+        }
+
+        bool Pop(Decision& decision)
+        {
+            std::size_t position = tail.load(std::memory_order_relaxed);
+            if (position == head.load(std::memory_order_acquire))
+                return false;
+            decision = decisions[position % kCapacity];
+            tail.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        std::uint64_t TakeDropped()
+        {
+            return dropped.exchange(0, std::memory_order_relaxed);
+        }
+
+    private:
+        std::array<Decision, kCapacity> decisions{};
+        std::atomic<std::size_t> head{ 0 };
+        std::atomic<std::size_t> tail{ 0 };
+        std::atomic<std::uint64_t> dropped{ 0 };
+    };
+}
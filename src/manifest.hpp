@@ -0,0 +1,257 @@
+#pragma once
+
+#include "callbacks.hpp"
+#include "renderscale.hpp"
+#include "scanner.hpp"
+#include "signatures.hpp"
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <safetyhook.hpp>
+
+// Patches described in MGSVFix.patches rather than in code, one ini section per patch. See the
+// comments in that file for the keys. Signatures from the manifest go into the same batched scan
+// as the built-in ones.
+namespace Manifest
+{
+    enum class Action : std::uint8_t
+    {
+        Bytes,          // Write Bytes at the match
+        WriteInt,       // Write Value (int32) to the address the rel32 at the match points at
+        WriteFloat,     // Same, as a float
+        Scale,          // Scales a float register by a RenderScale value at the match: Multiply in a code cave,
+                        // Set in a mid hook
+    };
+
+    enum class Op : std::uint8_t
+    {
+        Multiply,
+        Set,
+    };
+
+    struct NamedScale
+    {
+        const char* Name;
+        float RenderScale::Snapshot::* Value;
+    };
+
+    inline constexpr NamedScale kScales[] = {
+        { "AspectRatio",                &RenderScale::Snapshot::AspectRatio },
+        { "AspectMultiplier",           &RenderScale::Snapshot::AspectMultiplier },
+        { "InverseAspectMultiplier",    &RenderScale::Snapshot::InverseAspectMultiplier },
+        { "HUDWidth",                   &RenderScale::Snapshot::HUDWidth },
+        { "HUDHeight",                  &RenderScale::Snapshot::HUDHeight },
+        { "HUDWidthOffset",             &RenderScale::Snapshot::HUDWidthOffset },
+        { "HUDHeightOffset",            &RenderScale::Snapshot::HUDHeightOffset },
+        { "DepthOfFieldScale",          &RenderScale::Snapshot::DepthOfFieldScale },
+        { "ScopeScale",                 &RenderScale::Snapshot::ScopeScale },
+        { "MarkerSize",                 &RenderScale::Snapshot::MarkerSize },
+    };
+
+    struct ScaleHook
+    {
+        std::uint16_t Register = 0;     // Byte offset of the xmm register in SafetyHookContext
+        float RenderScale::Snapshot::* Value = nullptr;
+        Op Do = Op::Multiply;
+        bool WiderOnly = true;
+    };
+
+    // Signature points into Name and Pattern, so a parsed patch has to stay where it is (e.g. in a deque).
+    struct Patch
+    {
+        std::string Name;
+        Scanner::ParsedPattern Pattern;
+        Signatures::Signature Signature{};
+        std::ptrdiff_t Offset = 0;
+        std::size_t Matches = 1;        // 0 = any number of matches
+        Action Do = Action::Bytes;
+        std::vector<std::uint8_t> Bytes;
+        std::int32_t IntValue = 0;
+        float FloatValue = 0.00f;
+        ScaleHook Scale;
+    };
+
+    inline std::string_view Trim(std::string_view text)
+    {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+            text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
+            text.remove_suffix(1);
+        return text;
+    }
+
+    // Space separated two digit hex bytes, plus ?/?? wildcards when allowed.
+    inline bool ValidHex(std::string_view text, bool wildcards)
+    {
+        std::size_t tokens = 0;
+        for (text = Trim(text); !text.empty(); text = Trim(text)) {
+            auto space = text.find_first_of(" \t");
+            auto token = text.substr(0, space);
+            text.remove_prefix(token.size());
+            tokens++;
+            if (wildcards && (token == "?" || token == "??"))
+                continue;
+            if (token.size() != 2 || Scanner::HexDigit(token[0]) < 0 || Scanner::HexDigit(token[1]) < 0)
+                return false;
+        }
+        return tokens > 0;
+    }
+
+    template <typename T>
+    bool ParseNumber(std::string_view text, T& value)
+    {
+        text = Trim(text);
+        bool negative = !text.empty() && text.front() == '-';
+        if (negative)
+            text.remove_prefix(1);
+        int base = 10;
+        if (text.starts_with("0x") || text.starts_with("0X")) {
+            text.remove_prefix(2);
+            base = 16;
+        }
+        std::int64_t parsed = 0;
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), parsed, base);
+        if (error != std::errc{} || end != text.data() + text.size())
+            return false;
+        value = static_cast<T>(negative ? -parsed : parsed);
+        return true;
+    }
+
+    inline bool ParseFloat(std::string_view text, float& value)
+    {
+        text = Trim(text);
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc{} && end == text.data() + text.size();
+    }
+
+    // Fills patch from one manifest section. On failure error says which key was wrong.
+    inline bool Parse(Patch& patch, const std::string& name, const std::map<std::string, std::string>& keys, std::string& error)
+    {
+        auto get = [&](const char* key) -> std::string_view {
+            auto found = keys.find(key);
+            return found == keys.end() ? std::string_view{} : Trim(found->second);
+        };
+        auto fail = [&](const char* message) {
+            error = message;
+            return false;
+        };
+
+        patch.Name = name;
+        std::uint8_t games = 0;
+        auto game = get("Game");
+        if (game == "GZ")
+            games = Signatures::InGZ;
+        else if (game == "TPP")
+            games = Signatures::InTPP;
+        else if (game == "Both")
+            games = Signatures::InBoth;
+        else
+            return fail("Game must be GZ, TPP or Both.");
+
+        std::string signature(get("Signature"));
+        if (!ValidHex(signature, true))
+            return fail("Signature must be hex bytes and ?? wildcards.");
+        patch.Pattern = Scanner::Parse(signature.c_str());
+
+        if (auto offset = get("Offset"); !offset.empty() && !ParseNumber(offset, patch.Offset))
+            return fail("Offset isn't a number.");
+
+        if (auto matches = get("Matches"); matches == "All")
+            patch.Matches = 0;
+        else if (!matches.empty() && (!ParseNumber(matches, patch.Matches) || patch.Matches == 0 || patch.Matches > 64))
+            return fail("Matches must be 1-64 or All.");
+
+        auto action = get("Action");
+        if (action == "Bytes") {
+            patch.Do = Action::Bytes;
+            auto bytes = get("Bytes");
+            if (!ValidHex(bytes, false))
+                return fail("Bytes must be hex bytes.");
+            auto parsed = Scanner::Parse(std::string(bytes).c_str());
+            patch.Bytes.assign(parsed.Bytes.begin(), parsed.Bytes.begin() + parsed.Size);
+        }
+        else if (action == "WriteInt") {
+            patch.Do = Action::WriteInt;
+            if (!ParseNumber(get("Value"), patch.IntValue))
+                return fail("Value isn't an integer.");
+        }
+        else if (action == "WriteFloat") {
+            patch.Do = Action::WriteFloat;
+            if (!ParseFloat(get("Value"), patch.FloatValue))
+                return fail("Value isn't a number.");
+        }
+        else if (action == "Scale") {
+            patch.Do = Action::Scale;
+
+            auto reg = get("Register");
+            int index = -1;
+            if (!reg.starts_with("xmm") || !ParseNumber(reg.substr(3), index) || index < 0 || index > 15)
+                return fail("Register must be xmm0-xmm15.");
+            patch.Scale.Register = static_cast<std::uint16_t>(offsetof(SafetyHookContext, xmm0) + index * sizeof(SafetyHookContext::xmm0));
+
+            for (const auto& scale : kScales) {
+                if (get("Scale") == scale.Name)
+                    patch.Scale.Value = scale.Value;
+            }
+            if (!patch.Scale.Value)
+                return fail("Scale isn't a known RenderScale value.");
+
+            if (auto op = get("Op"); op == "Set")
+                patch.Scale.Do = Op::Set;
+            else if (!op.empty() && op != "Multiply")
+                return fail("Op must be Multiply or Set.");
+
+            if (auto when = get("When"); when == "Always")
+                patch.Scale.WiderOnly = false;
+            else if (!when.empty() && when != "Wider")
+                return fail("When must be Wider or Always.");
+        }
+        else {
+            return fail("Action must be Bytes, WriteInt, WriteFloat or Scale.");
+        }
+
+        patch.Signature = { patch.Name.c_str(), patch.Pattern, games, patch.Matches != 1 };
+        return true;
+    }
+
+    // Scale hooks read their settings from a fixed slot, each slot has its own callback so the hooks
+    // stay plain function pointers. Slots are filled before the hooks go live and only read afterwards.
+    constexpr std::size_t kMaxScaleHooks = 32;
+    inline std::array<ScaleHook, kMaxScaleHooks> scaleHooks{};
+
+    inline void RunScale(std::size_t slot, SafetyHookContext& ctx)
+    {
+        const ScaleHook& hook = scaleHooks[slot];
+        const auto& scale = Callbacks::renderScale.Load();
+        // Nothing is published until the game reports a resolution, every value is 0 until then.
+        if (!scale.ResX || (hook.WiderOnly && !scale.Wider))
+            return;
+
+        auto& target = reinterpret_cast<safetyhook::Xmm*>(reinterpret_cast<std::uint8_t*>(&ctx) + hook.Register)->f32[0];
+        if (hook.Do == Op::Set)
+            target = scale.*hook.Value;
+        else
+            target *= scale.*hook.Value;
+    }
+
+    template <std::size_t Slot>
+    inline constexpr auto kScaleCallback = [](SafetyHookContext& ctx) { RunScale(Slot, ctx); };
+
+    // Calls fn with the callback for slot.
+    template <typename Fn>
+    void WithScaleCallback(std::size_t slot, Fn&& fn)
+    {
+        [&]<std::size_t... Slots>(std::index_sequence<Slots...>) {
+            ((slot == Slots ? fn(kScaleCallback<Slots>) : void()), ...);
+        }(std::make_index_sequence<kMaxScaleHooks>());
+    }
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Minimal PE reader that works on any image laid out at its RVAs, so it builds outside Windows too.
+namespace PE
+{
+    constexpr std::uint32_t kSectionExecute = 0x20000000;
+
+    struct Section
+    {
+        std::string Name;
+        std::uint32_t VirtualAddress = 0;
+        std::uint32_t VirtualSize = 0;
+        std::uint32_t RawOffset = 0;
+        std::uint32_t RawSize = 0;
+        std::uint32_t Characteristics = 0;
+
+        bool Executable() const { return (Characteristics & kSectionExecute) != 0; }
+    };
+
+    struct Import
+    {
+        std::string Module;
+        std::uint32_t FirstThunk = 0;   // RVA of the IAT slots for this module
+    };
+
+    struct ModuleInfo
+    {
+        const std::uint8_t* Base = nullptr;
+        std::uint32_t SizeOfImage = 0;
+        std::uint32_t SizeOfHeaders = 0;
+        std::uint32_t Timestamp = 0;
+        std::uint32_t ImportDirectory = 0;      // RVA
+        std::uint32_t ImportDirectorySize = 0;
+        std::vector<Section> Sections;          // Sorted by VirtualAddress
+        std::vector<Import> Imports;
+
+        const Section* FindSection(std::string_view name) const
+        {
+            for (const auto& section : Sections) {
+                if (section.Name == name)
+                    return &section;
+            }
+            return nullptr;
+        }
+
+        const Section* SectionAt(std::uint32_t rva) const
+        {
+            for (const auto& section : Sections) {
+                if (rva >= section.VirtualAddress && rva < section.VirtualAddress + section.VirtualSize)
+                    return &section;
+            }
+            return nullptr;
+        }
+    };
+
+    template<typename T>
+    T Read(const std::uint8_t* base, std::size_t offset)
+    {
+        T value;
+        std::memcpy(&value, base + offset, sizeof(T));
+        return value;
+    }
+
+    // Parses the headers of a PE32+ image, of which size bytes can be read. Returns nothing if the
+    // headers don't look valid or don't fit.
+    inline std::optional<ModuleInfo> Parse(const std::uint8_t* base, std::size_t size, bool parseImports = true)
+    {
+        if (!base || size < 0x40 || Read<std::uint16_t>(base, 0x00) != 0x5A4D) // MZ
+            return std::nullopt;
+
+        std::size_t ntOffset = Read<std::uint32_t>(base, 0x3C);
+        std::size_t fileHeader = ntOffset + 4;
+        std::size_t optionalHeader = fileHeader + 20;
+        if (optionalHeader + 2 > size || Read<std::uint32_t>(base, ntOffset) != 0x00004550) // PE\0\0
+            return std::nullopt;
+        if (Read<std::uint16_t>(base, optionalHeader) != 0x20B) // PE32+
+            return std::nullopt;
+
+        // The optional header up to its data directories, and the section table after it.
+        auto sectionCount = Read<std::uint16_t>(base, fileHeader + 2);
+        auto optionalSize = Read<std::uint16_t>(base, fileHeader + 16);
+        std::size_t sectionTable = optionalHeader + optionalSize;
+        if (optionalSize < 112 || sectionTable + sectionCount * std::size_t(40) > size)
+            return std::nullopt;
+
+        ModuleInfo info;
+        info.Base = base;
+        info.Timestamp = Read<std::uint32_t>(base, fileHeader + 4);
+        info.SizeOfImage = Read<std::uint32_t>(base, optionalHeader + 56);
+        info.SizeOfHeaders = Read<std::uint32_t>(base, optionalHeader + 60);
+        if (optionalSize >= 112 + 16 && Read<std::uint32_t>(base, optionalHeader + 108) > 1) { // NumberOfRvaAndSizes
+            info.ImportDirectory = Read<std::uint32_t>(base, optionalHeader + 112 + 8);
+            info.ImportDirectorySize = Read<std::uint32_t>(base, optionalHeader + 112 + 12);
+        }
+
+        for (std::uint16_t i = 0; i < sectionCount; ++i) {
+            const std::uint8_t* header = base + sectionTable + i * 40;
+            Section section;
+            section.Name.assign(reinterpret_cast<const char*>(header), strnlen(reinterpret_cast<const char*>(header), 8));
+            section.VirtualSize = Read<std::uint32_t>(header, 8);
+            section.VirtualAddress = Read<std::uint32_t>(header, 12);
+            section.RawSize = Read<std::uint32_t>(header, 16);
+            section.RawOffset = Read<std::uint32_t>(header, 20);
+            section.Characteristics = Read<std::uint32_t>(header, 36);
+            if (!section.VirtualSize)
+                section.VirtualSize = section.RawSize;
+            if (section.VirtualAddress >= info.SizeOfImage)
+                continue;
+            if (section.VirtualSize > info.SizeOfImage - section.VirtualAddress)
+                section.VirtualSize = info.SizeOfImage - section.VirtualAddress;
+            info.Sections.push_back(std::move(section));
+        }
+        std::sort(info.Sections.begin(), info.Sections.end(), [](const Section& a, const Section& b) {
+            return a.VirtualAddress < b.VirtualAddress;
+        });
+
+        std::size_t limit = std::min<std::size_t>(size, info.SizeOfImage);
+        if (parseImports && info.ImportDirectory && info.ImportDirectory < limit) {
+            for (std::size_t offset = info.ImportDirectory; offset + 20 <= limit; offset += 20) {
+                auto name = Read<std::uint32_t>(base, offset + 12);
+                auto firstThunk = Read<std::uint32_t>(base, offset + 16);
+                if (!name || !firstThunk || name >= limit)
+                    break;
+                const char* moduleName = reinterpret_cast<const char*>(base + name);
+                info.Imports.push_back({ std::string(moduleName, strnlen(moduleName, limit - name)), firstThunk });
+            }
+        }
+
+        return info;
+    }
+}
@@ -0,0 +1,267 @@
+#pragma once
+
+// Per-hook call counters and cost histograms. Only built with MGSVFIX_PROFILE defined
+// (xmake f --profile=y), otherwise every entry point below is an empty inline function.
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef MGSVFIX_PROFILE
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define PROFILER_TSC 1
+#else
+#define PROFILER_TSC 0
+#endif
+
+#include <spdlog/spdlog.h>
+
+namespace Profiler
+{
+    constexpr std::size_t kMaxHooks = 64;
+    constexpr std::size_t kBuckets = 128;
+    constexpr auto kReportInterval = std::chrono::seconds(10);
+
+    // Ticks are TSC cycles where available, steady_clock nanoseconds otherwise.
+    inline std::uint64_t Now()
+    {
+#if PROFILER_TSC
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    // Log-linear buckets: exact below 8, then 4 buckets per power of two.
+    constexpr std::size_t Bucket(std::uint64_t ticks)
+    {
+        if (ticks < 8)
+            return static_cast<std::size_t>(ticks);
+        std::size_t exponent = std::bit_width(ticks) - 1;
+        std::size_t bucket = 8 + (exponent - 3) * 4 + ((ticks >> (exponent - 2)) & 3);
+        return std::min(bucket, kBuckets - 1);
+    }
+
+    // Largest tick count that lands in a bucket.
+    constexpr std::uint64_t BucketLimit(std::size_t bucket)
+    {
+        if (bucket < 8)
+            return bucket;
+        std::size_t exponent = (bucket - 8) / 4 + 3;
+        std::uint64_t sub = (bucket - 8) % 4;
+        return ((4 + sub + 1) << (exponent - 2)) - 1;
+    }
+
+    // One hook's numbers for one thread. Only the owning thread writes, so plain relaxed
+    // load/store is enough and the reporter never sees torn values.
+    struct alignas(64) Counters
+    {
+        std::atomic<std::uint64_t> Calls{ 0 };
+        std::atomic<std::uint64_t> Ticks{ 0 };
+        std::array<std::atomic<std::uint32_t>, kBuckets> Buckets{};
+    };
+
+    struct ThreadSlots
+    {
+        std::array<Counters, kMaxHooks> Hooks;
+    };
+
+    struct State
+    {
+        std::mutex Mutex;
+        std::vector<std::unique_ptr<ThreadSlots>> Threads;     // Kept after threads exit
+        std::array<const char*, kMaxHooks> Names{};
+        std::atomic<std::size_t> HookCount{ 0 };
+        std::atomic<std::uint64_t> Frames{ 0 };
+    };
+
+    inline State& Get()
+    {
+        static State* state = new State();
+        return *state;
+    }
+
+    // Returns the slot index for a hook, or kMaxHooks (not profiled) once the table is full.
+    inline std::size_t Register(const char* name)
+    {
+        State& state = Get();
+        std::scoped_lock lock(state.Mutex);
+        std::size_t id = state.HookCount.load(std::memory_order_relaxed);
+        if (id == kMaxHooks)
+            return kMaxHooks;
+        state.Names[id] = name;
+        state.HookCount.store(id + 1, std::memory_order_release);
+        return id;
+    }
+
+    inline ThreadSlots& Slots()
+    {
+        thread_local ThreadSlots* slots = [] {
+            State& state = Get();
+            std::scoped_lock lock(state.Mutex);
+            return state.Threads.emplace_back(std::make_unique<ThreadSlots>()).get();
+        }();
+        return *slots;
+    }
+
+    inline void Record(std::size_t id, std::uint64_t ticks)
+    {
+        if (id >= kMaxHooks)
+            return;
+
+        Counters& counters = Slots().Hooks[id];
+        auto bump = [](auto& value, auto amount) {
+            value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        };
+        bump(counters.Calls, 1u);
+        bump(counters.Ticks, ticks);
+        bump(counters.Buckets[Bucket(ticks)], 1u);
+    }
+
+    class Scope
+    {
+    public:
+        explicit Scope(std::size_t id) : id(id), start(Now()) {}
+        ~Scope() { Record(id, Now() - start); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        std::size_t id;
+        std::uint64_t start;
+    };
+
+    inline void Frame()
+    {
+        Get().Frames.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Totals for one hook summed over every thread.
+    struct Totals
+    {
+        std::uint64_t Calls = 0;
+        std::uint64_t Ticks = 0;
+        std::array<std::uint64_t, kBuckets> Buckets{};
+    };
+
+    inline std::vector<Totals> Collect()
+    {
+        State& state = Get();
+        std::size_t hooks = state.HookCount.load(std::memory_order_acquire);
+        std::vector<Totals> totals(hooks);
+
+        std::scoped_lock lock(state.Mutex);
+        for (const auto& thread : state.Threads) {
+            for (std::size_t id = 0; id < hooks; ++id) {
+                const Counters& counters = thread->Hooks[id];
+                totals[id].Calls += counters.Calls.load(std::memory_order_relaxed);
+                totals[id].Ticks += counters.Ticks.load(std::memory_order_relaxed);
+                for (std::size_t bucket = 0; bucket < kBuckets; ++bucket)
+                    totals[id].Buckets[bucket] += counters.Buckets[bucket].load(std::memory_order_relaxed);
+            }
+        }
+        return totals;
+    }
+
+    // Logs calls/frame, mean and p99 per hook every kReportInterval. Runs on its own thread so
+    // formatting never lands on a game thread.
+    inline void Start()
+    {
+        std::thread([] {
+            State& state = Get();
+            std::vector<Totals> previous;
+            std::uint64_t previousFrames = 0;
+            auto previousTime = std::chrono::steady_clock::now();
+            std::uint64_t previousTicks = Now();
+
+            for (;;) {
+                std::this_thread::sleep_for(kReportInterval);
+
+                auto time = std::chrono::steady_clock::now();
+                std::uint64_t ticks = Now();
+                double elapsedNs = std::chrono::duration<double, std::nano>(time - previousTime).count();
+                double nsPerTick = ticks > previousTicks ? elapsedNs / double(ticks - previousTicks) : 1.0;
+                previousTime = time;
+                previousTicks = ticks;
+
+                std::uint64_t frames = state.Frames.load(std::memory_order_relaxed);
+                std::uint64_t intervalFrames = frames - previousFrames;
+                previousFrames = frames;
+
+                auto totals = Collect();
+                previous.resize(totals.size());
+
+                spdlog::info("Profiler: {:d} frames in the last {:.1f}s.", intervalFrames, elapsedNs / 1e9);
+                for (std::size_t id = 0; id < totals.size(); ++id) {
+                    std::uint64_t calls = totals[id].Calls - previous[id].Calls;
+                    if (!calls)
+                        continue;
+
+                    double meanNs = double(totals[id].Ticks - previous[id].Ticks) / double(calls) * nsPerTick;
+
+                    std::uint64_t rank = calls - calls / 100;
+                    std::uint64_t seen = 0;
+                    std::size_t p99 = kBuckets - 1;
+                    for (std::size_t bucket = 0; bucket < kBuckets; ++bucket) {
+                        seen += totals[id].Buckets[bucket] - previous[id].Buckets[bucket];
+                        if (seen >= rank) {
+                            p99 = bucket;
+                            break;
+                        }
+                    }
+
+                    if (intervalFrames)
+                        spdlog::info("Profiler: {:s}: {:d} calls, {:.2f}/frame, mean {:.0f}ns, p99 {:.0f}ns", state.Names[id], calls, double(calls) / double(intervalFrames), meanNs, double(BucketLimit(p99)) * nsPerTick);
+                    else
+                        spdlog::info("Profiler: {:s}: {:d} calls, mean {:.0f}ns, p99 {:.0f}ns", state.Names[id], calls, meanNs, double(BucketLimit(p99)) * nsPerTick);
+                }
+                previous = std::move(totals);
+            }
+        }).detach();
+    }
+
+    // Wraps a captureless hook callback with a call counter and timer. Each callback type gets its
+    // own wrapper function, so the result is still a plain function pointer.
+    template <typename Context, typename Fn>
+    auto Wrap(Fn, const char* name) -> void (*)(Context&)
+    {
+        static std::size_t id = Register(name);
+        return [](Context& ctx) {
+            Scope scope(id);
+            Fn{}(ctx);
+        };
+    }
+}
+
+#else
+
+namespace Profiler
+{
+    inline void Frame() {}
+    inline void Start() {}
+
+    template <typename Context, typename Fn>
+    auto Wrap(Fn destination, const char*) -> void (*)(Context&)
+    {
+        return destination;
+    }
+}
+
+#endif
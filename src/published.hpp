@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Util
+{
+    // Immutable snapshots of T with a single writer and any number of readers. Readers take one
+    // acquire load and get a snapshot that never changes under them. Replaced snapshots are kept
+    // alive rather than reclaimed, since a reader may still hold one and updates are rare.
+    template <typename T>
+    class Published
+    {
+    public:
+        Published() : current(&initial) {}
+
+        const T& Load() const
+        {
+            return *current.load(std::memory_order_acquire);
+        }
+
+        void Store(const T& value)
+        {
+            std::scoped_lock lock(mutex);
+            history.push_back(std::make_unique<T>(value));
+            current.store(history.back().get(), std::memory_order_release);
+        }
+
+    private:
+        T initial{};
+        std::atomic<const T*> current;
+        std::mutex mutex;
+        std::vector<std::unique_ptr<T>> history;
+    };
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "published.hpp"
+
+// Everything the hooks derive from the current resolution, computed once per resolution change.
+namespace RenderScale
+{
+    constexpr float kNativeAspect = 16.00f / 9.00f;
+
+    struct alignas(64) Snapshot
+    {
+        int ResX = 0;
+        int ResY = 0;
+        bool Wider = false;                     // AspectRatio > kNativeAspect, gates most fixes
+        float AspectRatio = 0.00f;
+        float AspectMultiplier = 0.00f;         // AspectRatio / kNativeAspect
+        float InverseAspectMultiplier = 0.00f;  // 1 / AspectMultiplier
+        float HUDWidth = 0.00f;
+        float HUDHeight = 0.00f;
+        float HUDWidthOffset = 0.00f;
+        float HUDHeightOffset = 0.00f;
+        float DepthOfFieldScale = 0.00f;        // (HUDWidth * 0.85) / 1920
+        float ScopeScale = 1.00f;               // AspectRatio / 2 when wider, otherwise 1
+        float MarkerSize = 64.00f;              // 64 * AspectMultiplier when wider, otherwise 64
+    };
+
+    constexpr Snapshot Compute(int resX, int resY)
+    {
+        Snapshot scale;
+        scale.ResX = resX;
+        scale.ResY = resY;
+        if (resX <= 0 || resY <= 0)
+            return scale;
+
+        scale.AspectRatio = (float)resX / (float)resY;
+        scale.AspectMultiplier = scale.AspectRatio / kNativeAspect;
+        scale.InverseAspectMultiplier = 1.00f / scale.AspectMultiplier;
+        scale.Wider = scale.AspectRatio > kNativeAspect;
+
+        // HUD
+        scale.HUDWidth = (float)resY * kNativeAspect;
+        scale.HUDHeight = (float)resY;
+        scale.HUDWidthOffset = (float)(resX - scale.HUDWidth) / 2.00f;
+        scale.HUDHeightOffset = 0.00f;
+        if (scale.AspectRatio < kNativeAspect) {
+            scale.HUDWidth = (float)resX;
+            scale.HUDHeight = (float)resX / kNativeAspect;
+            scale.HUDWidthOffset = 0.00f;
+            scale.HUDHeightOffset = (float)(resY - scale.HUDHeight) / 2.00f;
+        }
+
+        scale.DepthOfFieldScale = (scale.HUDWidth * 0.85f) * (1.00f / 1920.00f);
+        scale.ScopeScale = scale.Wider ? scale.AspectRatio / 2.00f : 1.00f;
+        scale.MarkerSize = scale.Wider ? 64.00f * scale.AspectMultiplier : 64.00f;
+        return scale;
+    }
+
+    // Written by the resolution hook, read by every other hook.
+    using Published = Util::Published<Snapshot>;
+}
@@ -0,0 +1,1070 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define SCANNER_X86_64 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#else
+#define SCANNER_X86_64 0
+#endif
+
+// MSVC lets any function use any intrinsic, GCC/Clang need the ISA enabled per function.
+#if SCANNER_X86_64 && !defined(_MSC_VER)
+#define SCANNER_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SCANNER_TARGET(isa)
+#endif
+
+namespace Scanner
+{
+    enum class Isa
+    {
+        Scalar,
+        SSE2,
+        AVX2,
+    };
+
+    // A contiguous block of readable memory to scan.
+    struct Region
+    {
+        const std::uint8_t* Data;
+        std::size_t Size;
+    };
+
+    // Signature in byte + mask form. Bytes/Mask are padded with wildcards to a multiple of 16
+    // so the SIMD verify step can compare whole blocks. Doesn't own its storage, which lives in a
+    // Literal (compile-time) or a ParsedPattern (runtime).
+    struct Pattern
+    {
+        const std::uint8_t* Bytes = nullptr;
+        const std::uint8_t* Mask = nullptr;     // 0xFF = must match, 0x00 = wildcard
+        std::size_t Size = 0;                   // Unpadded length
+        std::size_t Padded = 0;                 // Length of Bytes/Mask
+        std::size_t Anchor = 0;                 // Offset of the rarest solid byte
+        std::size_t SecondAnchor = 0;           // Offset of the next rarest solid byte
+        bool Solid = false;                     // Has at least one non-wildcard byte
+    };
+
+    // Rough ranking of how often a byte shows up in x64 code, most common first.
+    // Used to anchor the SIMD prefilter on bytes that produce few false candidates.
+    constexpr int ByteCommonness(std::uint8_t byte)
+    {
+        constexpr std::uint8_t kCommon[] = {
+            0x00, 0xFF, 0x48, 0xCC, 0x8B, 0x89, 0x0F, 0x24, 0x4C, 0x44, 0x8D, 0x41, 0x83, 0x85, 0xC0,
+            0x01, 0xE8, 0x49, 0x74, 0x75, 0x10, 0x08, 0x45, 0xF3, 0x20, 0xC3, 0x33, 0x4D, 0x90, 0x28,
+        };
+        for (std::size_t i = 0; i < sizeof(kCommon); ++i) {
+            if (kCommon[i] == byte)
+                return static_cast<int>(sizeof(kCommon) - i);
+        }
+        return 0;
+    }
+
+    constexpr void ChooseAnchors(Pattern& pattern)
+    {
+        auto rarest = [&](std::size_t skip) {
+            std::size_t best = pattern.Size;
+            for (std::size_t i = 0; i < pattern.Size; ++i) {
+                if (!pattern.Mask[i] || i == skip)
+                    continue;
+                if (best == pattern.Size || ByteCommonness(pattern.Bytes[i]) < ByteCommonness(pattern.Bytes[best]))
+                    best = i;
+            }
+            return best;
+        };
+
+        pattern.Anchor = rarest(pattern.Size);
+        pattern.Solid = pattern.Anchor < pattern.Size;
+        if (!pattern.Solid) {
+            pattern.Anchor = pattern.SecondAnchor = 0;
+            return;
+        }
+
+        // Patterns with a single solid byte just compare it twice.
+        pattern.SecondAnchor = rarest(pattern.Anchor);
+        if (pattern.SecondAnchor == pattern.Size)
+            pattern.SecondAnchor = pattern.Anchor;
+    }
+
+    constexpr int HexDigit(char c)
+    {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    // Runtime-parsed signature, for patterns that only exist as strings (manifests, tools).
+    // Converts to a Pattern view, so it has to outlive any scan using it.
+    struct ParsedPattern
+    {
+        std::vector<std::uint8_t> Bytes;
+        std::vector<std::uint8_t> Mask;
+        std::size_t Size = 0;
+        std::size_t Anchor = 0;
+        std::size_t SecondAnchor = 0;
+        bool Solid = false;
+
+        operator Pattern() const
+        {
+            return { Bytes.data(), Mask.data(), Size, Bytes.size(), Anchor, SecondAnchor, Solid };
+        }
+    };
+
+    // Parses "48 8B ?? ?? E8" style signatures. A single "?" is also accepted as a wildcard.
+    inline ParsedPattern Parse(const char* signature)
+    {
+        ParsedPattern parsed;
+        for (const char* current = signature; *current; ) {
+            if (*current == '?') {
+                ++current;
+                if (*current == '?')
+                    ++current;
+                parsed.Bytes.push_back(0x00);
+                parsed.Mask.push_back(0x00);
+            }
+            else if (int high = HexDigit(*current); high >= 0) {
+                int value = high;
+                ++current;
+                if (int low = HexDigit(*current); low >= 0) {
+                    value = (value << 4) | low;
+                    ++current;
+                }
+                parsed.Bytes.push_back(static_cast<std::uint8_t>(value));
+                parsed.Mask.push_back(0xFF);
+            }
+            else {
+                ++current;
+            }
+        }
+
+        parsed.Size = parsed.Bytes.size();
+        std::size_t padded = (parsed.Size + 15) & ~std::size_t(15);
+        parsed.Bytes.resize(padded, 0x00);
+        parsed.Mask.resize(padded, 0x00);
+
+        Pattern pattern = parsed;
+        ChooseAnchors(pattern);
+        parsed.Anchor = pattern.Anchor;
+        parsed.SecondAnchor = pattern.SecondAnchor;
+        parsed.Solid = pattern.Solid;
+        return parsed;
+    }
+
+    // Compile-time signatures: "48 8B ?? ?? E8"_sig is validated and parsed by the compiler into
+    // aligned arrays sized to the pattern. Only two-digit hex bytes and ?/?? wildcards separated by
+    // single spaces are accepted, anything else fails to compile.
+    template <std::size_t Length>
+    struct FixedString
+    {
+        char Text[Length]{};
+
+        consteval FixedString(const char (&text)[Length])
+        {
+            std::copy_n(text, Length, Text);
+        }
+
+        consteval std::string_view View() const { return { Text, Length - 1 }; }
+    };
+
+    consteval std::size_t CountLiteralBytes(std::string_view text)
+    {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < text.size(); ++count) {
+            if (text[i] == '?')
+                i += (i + 1 < text.size() && text[i + 1] == '?') ? 2 : 1;
+            else if (i + 1 < text.size() && HexDigit(text[i]) >= 0 && HexDigit(text[i + 1]) >= 0)
+                i += 2;
+            else
+                throw "Signature: expected a two digit hex byte or a ?? wildcard";
+
+            if (i < text.size()) {
+                if (text[i] != ' ' || i + 1 == text.size())
+                    throw "Signature: bytes must be separated by single spaces";
+                ++i;
+            }
+        }
+        if (!count)
+            throw "Signature: empty pattern";
+        return count;
+    }
+
+    template <std::size_t N>
+    struct Literal
+    {
+        static constexpr std::size_t kPadded = (N + 15) & ~std::size_t(15);
+
+        alignas(16) std::array<std::uint8_t, kPadded> Bytes{};
+        alignas(16) std::array<std::uint8_t, kPadded> Mask{};
+        std::size_t Anchor = 0;
+        std::size_t SecondAnchor = 0;
+        bool Solid = false;
+
+        consteval explicit Literal(std::string_view text)
+        {
+            std::size_t index = 0;
+            for (std::size_t i = 0; i < text.size(); ++i) {
+                if (text[i] == '?') {
+                    if (i + 1 < text.size() && text[i + 1] == '?')
+                        ++i;
+                    Bytes[index] = 0x00;
+                    Mask[index++] = 0x00;
+                }
+                else if (text[i] != ' ') {
+                    Bytes[index] = static_cast<std::uint8_t>((HexDigit(text[i]) << 4) | HexDigit(text[i + 1]));
+                    Mask[index++] = 0xFF;
+                    ++i;
+                }
+            }
+
+            Pattern pattern = *this;
+            ChooseAnchors(pattern);
+            Anchor = pattern.Anchor;
+            SecondAnchor = pattern.SecondAnchor;
+            Solid = pattern.Solid;
+        }
+
+        constexpr operator Pattern() const
+        {
+            return { Bytes.data(), Mask.data(), N, kPadded, Anchor, SecondAnchor, Solid };
+        }
+    };
+
+    // One static instance per distinct literal, so the Pattern views handed out stay valid.
+    template <FixedString Text>
+    inline constexpr Literal<CountLiteralBytes(Text.View())> kLiteral{ Text.View() };
+
+    namespace Literals
+    {
+        template <FixedString Text>
+        consteval Pattern operator""_sig()
+        {
+            return kLiteral<Text>;
+        }
+    }
+
+    inline bool MatchesAtScalar(const std::uint8_t* data, const Pattern& pattern)
+    {
+        for (std::size_t j = 0; j < pattern.Size; ++j) {
+            if ((data[j] ^ pattern.Bytes[j]) & pattern.Mask[j])
+                return false;
+        }
+        return true;
+    }
+
+    // Calls onMatch(address) for every match starting at or after data + from, in address order.
+    // onMatch returns true to stop the scan. Returns true if the scan was stopped.
+    template <typename OnMatch>
+    bool ScanScalar(const std::uint8_t* data, std::size_t size, const Pattern& pattern, std::size_t from, OnMatch&& onMatch)
+    {
+        if (size < pattern.Size)
+            return false;
+
+        const std::size_t last = size - pattern.Size;
+        const std::uint8_t anchor = pattern.Solid ? pattern.Bytes[pattern.Anchor] : 0;
+        for (std::size_t i = from; i <= last; ++i) {
+            if (pattern.Solid && data[i + pattern.Anchor] != anchor)
+                continue;
+            if (MatchesAtScalar(data + i, pattern) && onMatch(data + i))
+                return true;
+        }
+        return false;
+    }
+
+#if SCANNER_X86_64
+    SCANNER_TARGET("sse2")
+    inline bool MatchesAtSSE2(const std::uint8_t* data, const std::uint8_t* end, const Pattern& pattern)
+    {
+        const std::size_t padded = pattern.Padded;
+        if (static_cast<std::size_t>(end - data) < padded)
+            return MatchesAtScalar(data, pattern);
+
+        for (std::size_t j = 0; j < padded; j += 16) {
+            __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + j));
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.Bytes + j));
+            __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.Mask + j));
+            __m128i diff = _mm_and_si128(_mm_xor_si128(value, bytes), mask);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) != 0xFFFF)
+                return false;
+        }
+        return true;
+    }
+
+    template <typename OnMatch>
+    SCANNER_TARGET("sse2")
+    bool ScanSSE2(const std::uint8_t* data, std::size_t size, const Pattern& pattern, OnMatch&& onMatch)
+    {
+        if (!pattern.Solid || size < pattern.Size)
+            return ScanScalar(data, size, pattern, 0, onMatch);
+
+        const std::uint8_t* end = data + size;
+        const std::size_t count = size - pattern.Size + 1; // Number of candidate start positions
+        const __m128i first = _mm_set1_epi8(static_cast<char>(pattern.Bytes[pattern.Anchor]));
+        const __m128i second = _mm_set1_epi8(static_cast<char>(pattern.Bytes[pattern.SecondAnchor]));
+
+        std::size_t i = 0;
+        for (; i + 16 <= count; i += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + pattern.Anchor));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + pattern.SecondAnchor));
+            auto bits = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, second))));
+            while (bits) {
+                const std::uint8_t* candidate = data + i + std::countr_zero(bits);
+                if (MatchesAtSSE2(candidate, end, pattern) && onMatch(candidate))
+                    return true;
+                bits &= bits - 1;
+            }
+        }
+        return ScanScalar(data, size, pattern, i, onMatch);
+    }
+
+    template <typename OnMatch>
+    SCANNER_TARGET("avx2")
+    bool ScanAVX2(const std::uint8_t* data, std::size_t size, const Pattern& pattern, OnMatch&& onMatch)
+    {
+        if (!pattern.Solid || size < pattern.Size)
+            return ScanScalar(data, size, pattern, 0, onMatch);
+
+        const std::uint8_t* end = data + size;
+        const std::size_t count = size - pattern.Size + 1;
+        const __m256i first = _mm256_set1_epi8(static_cast<char>(pattern.Bytes[pattern.Anchor]));
+        const __m256i second = _mm256_set1_epi8(static_cast<char>(pattern.Bytes[pattern.SecondAnchor]));
+
+        std::size_t i = 0;
+        for (; i + 32 <= count; i += 32) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + pattern.Anchor));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + pattern.SecondAnchor));
+            auto bits = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, second))));
+            while (bits) {
+                const std::uint8_t* candidate = data + i + std::countr_zero(bits);
+                if (MatchesAtSSE2(candidate, end, pattern) && onMatch(candidate))
+                    return true;
+                bits &= bits - 1;
+            }
+        }
+        return ScanScalar(data, size, pattern, i, onMatch);
+    }
+
+    inline void CpuId(int leaf, int subleaf, int regs[4])
+    {
+#if defined(_MSC_VER)
+        __cpuidex(regs, leaf, subleaf);
+#else
+        unsigned int a, b, c, d;
+        __cpuid_count(leaf, subleaf, a, b, c, d);
+        regs[0] = static_cast<int>(a);
+        regs[1] = static_cast<int>(b);
+        regs[2] = static_cast<int>(c);
+        regs[3] = static_cast<int>(d);
+#endif
+    }
+
+    inline std::uint64_t XGetBv()
+    {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        std::uint32_t lo, hi;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        return (static_cast<std::uint64_t>(hi) << 32) | lo;
+#endif
+    }
+#endif
+
+    inline bool MatchesAt(const std::uint8_t* data, const std::uint8_t* end, const Pattern& pattern)
+    {
+#if SCANNER_X86_64
+        return MatchesAtSSE2(data, end, pattern);
+#else
+        return MatchesAtScalar(data, pattern);
+#endif
+    }
+
+    inline Isa DetectIsa()
+    {
+#if SCANNER_X86_64
+        int regs[4];
+        CpuId(0, 0, regs);
+        int maxLeaf = regs[0];
+
+        // AVX2 needs both the CPU flag and the OS saving YMM state (OSXSAVE + XCR0 bits 1/2).
+        CpuId(1, 0, regs);
+        bool osxsave = (regs[2] & (1 << 27)) != 0;
+        bool avx = (regs[2] & (1 << 28)) != 0;
+        if (maxLeaf >= 7 && osxsave && avx && (XGetBv() & 0x6) == 0x6) {
+            CpuId(7, 0, regs);
+            if (regs[1] & (1 << 5))
+                return Isa::AVX2;
+        }
+        return Isa::SSE2;
+#else
+        return Isa::Scalar;
+#endif
+    }
+
+    inline Isa ActiveIsa()
+    {
+        static const Isa isa = DetectIsa();
+        return isa;
+    }
+
+    inline const char* IsaName(Isa isa)
+    {
+        switch (isa) {
+        case Isa::AVX2: return "AVX2";
+        case Isa::SSE2: return "SSE2";
+        default: return "Scalar";
+        }
+    }
+
+    template <typename OnMatch>
+    bool Scan(const std::uint8_t* data, std::size_t size, const Pattern& pattern, OnMatch&& onMatch, Isa isa = ActiveIsa())
+    {
+#if SCANNER_X86_64
+        if (isa == Isa::AVX2)
+            return ScanAVX2(data, size, pattern, onMatch);
+        if (isa == Isa::SSE2)
+            return ScanSSE2(data, size, pattern, onMatch);
+#endif
+        return ScanScalar(data, size, pattern, 0, onMatch);
+    }
+
+    inline const std::uint8_t* FindFirst(const std::uint8_t* data, std::size_t size, const Pattern& pattern, Isa isa = ActiveIsa())
+    {
+        const std::uint8_t* result = nullptr;
+        Scan(data, size, pattern, [&](const std::uint8_t* match) {
+            result = match;
+            return true;
+        }, isa);
+        return result;
+    }
+
+    inline std::vector<const std::uint8_t*> FindAll(const std::uint8_t* data, std::size_t size, const Pattern& pattern, Isa isa = ActiveIsa())
+    {
+        std::vector<const std::uint8_t*> results;
+        Scan(data, size, pattern, [&](const std::uint8_t* match) {
+            results.push_back(match);
+            return false;
+        }, isa);
+        return results;
+    }
+
+    inline const std::uint8_t* FindFirst(const std::vector<Region>& regions, const Pattern& pattern, Isa isa = ActiveIsa())
+    {
+        for (const auto& region : regions) {
+            if (auto match = FindFirst(region.Data, region.Size, pattern, isa))
+                return match;
+        }
+        return nullptr;
+    }
+
+    inline std::vector<const std::uint8_t*> FindAll(const std::vector<Region>& regions, const Pattern& pattern, Isa isa = ActiveIsa())
+    {
+        std::vector<const std::uint8_t*> results;
+        for (const auto& region : regions) {
+            auto matches = FindAll(region.Data, region.Size, pattern, isa);
+            results.insert(results.end(), matches.begin(), matches.end());
+        }
+        return results;
+    }
+
+    enum class Mode
+    {
+        First,  // Lowest matching address only
+        All,    // Every match, in address order
+    };
+
+    struct MultiEntry
+    {
+        Pattern Signature;
+        Mode Wanted = Mode::First;
+        std::size_t KeywordOffset = 0;  // Start of the longest solid run inside the pattern
+        std::size_t KeywordSize = 0;
+    };
+
+    // Many patterns compiled into one automaton. Aho-Corasick runs over the longest solid run
+    // of each pattern and every keyword hit is then verified against the full pattern.
+    struct MultiPattern
+    {
+        static constexpr std::uint32_t kHasOutput = 0x80000000u;
+
+        std::vector<MultiEntry> Entries;
+        std::array<std::uint8_t, 256> ByteClass{};  // Bytes that never occur in a keyword share class 0
+        std::uint32_t Classes = 1;
+        std::vector<std::uint32_t> Next;            // DFA transitions. Indexed by row + class, holds the target row
+                                                    // (state * Classes) with kHasOutput set if it reports keywords
+        std::size_t MaxKeyword = 1;
+        std::vector<std::uint32_t> OutputStart;     // Per state, range into Outputs
+        std::vector<std::uint32_t> Outputs;         // Entry indices whose keyword ends in that state
+    };
+
+    inline void LongestSolidRun(const Pattern& pattern, std::size_t& offset, std::size_t& size)
+    {
+        offset = size = 0;
+        for (std::size_t i = 0; i < pattern.Size; ) {
+            if (!pattern.Mask[i]) {
+                ++i;
+                continue;
+            }
+            std::size_t start = i;
+            while (i < pattern.Size && pattern.Mask[i])
+                ++i;
+            if (i - start > size) {
+                offset = start;
+                size = i - start;
+            }
+        }
+    }
+
+    inline MultiPattern BuildMultiPattern(const std::vector<std::pair<Pattern, Mode>>& patterns)
+    {
+        MultiPattern multi;
+        for (const auto& [pattern, mode] : patterns) {
+            MultiEntry entry{ pattern, mode };
+            LongestSolidRun(entry.Signature, entry.KeywordOffset, entry.KeywordSize);
+            multi.MaxKeyword = std::max(multi.MaxKeyword, entry.KeywordSize);
+            multi.Entries.push_back(std::move(entry));
+        }
+
+        // Keyword trie, -1 = no edge
+        std::vector<std::array<std::int32_t, 256>> trie(1);
+        trie[0].fill(-1);
+        std::vector<std::vector<std::uint32_t>> outputs(1);
+        for (std::uint32_t index = 0; index < multi.Entries.size(); ++index) {
+            const auto& entry = multi.Entries[index];
+            if (!entry.KeywordSize)
+                continue;
+
+            std::int32_t state = 0;
+            for (std::size_t j = 0; j < entry.KeywordSize; ++j) {
+                std::uint8_t byte = entry.Signature.Bytes[entry.KeywordOffset + j];
+                if (trie[state][byte] < 0) {
+                    trie[state][byte] = static_cast<std::int32_t>(trie.size());
+                    trie.emplace_back().fill(-1);
+                    outputs.emplace_back();
+                }
+                state = trie[state][byte];
+            }
+            outputs[state].push_back(index);
+        }
+
+        // Collapse the alphabet so the DFA stays small enough to live in L1.
+        for (const auto& node : trie) {
+            for (int byte = 0; byte < 256; ++byte) {
+                if (node[byte] >= 0 && !multi.ByteClass[byte])
+                    multi.ByteClass[byte] = static_cast<std::uint8_t>(multi.Classes++);
+            }
+        }
+
+        // Breadth-first pass turns the trie into a full DFA and folds fail-link outputs in.
+        const std::size_t states = trie.size();
+        const std::uint32_t classes = multi.Classes;
+        std::vector<int> representative(classes, 0); // A byte of each class, class 0 has no trie edges
+        for (int byte = 0; byte < 256; ++byte) {
+            if (multi.ByteClass[byte])
+                representative[multi.ByteClass[byte]] = byte;
+        }
+
+        multi.Next.assign(states * classes, 0);
+        std::vector<std::uint32_t> fail(states, 0);
+        std::vector<std::uint32_t> queue;
+        queue.reserve(states);
+        for (std::uint32_t c = 1; c < classes; ++c) {
+            if (std::int32_t child = trie[0][representative[c]]; child >= 0) {
+                multi.Next[c] = static_cast<std::uint32_t>(child);
+                queue.push_back(multi.Next[c]);
+            }
+        }
+        for (std::size_t head = 0; head < queue.size(); ++head) {
+            std::uint32_t state = queue[head];
+            const auto& inherited = outputs[fail[state]];
+            outputs[state].insert(outputs[state].end(), inherited.begin(), inherited.end());
+            for (std::uint32_t c = 0; c < classes; ++c) {
+                std::uint32_t fallback = multi.Next[fail[state] * classes + c];  // Not flagged yet
+                std::int32_t child = c ? trie[state][representative[c]] : -1;
+                if (child >= 0) {
+                    fail[child] = fallback;
+                    multi.Next[state * classes + c] = static_cast<std::uint32_t>(child);
+                    queue.push_back(static_cast<std::uint32_t>(child));
+                }
+                else {
+                    multi.Next[state * classes + c] = fallback;
+                }
+            }
+        }
+
+        // Store target rows rather than state numbers, and flag the ones that report keywords
+        // so the scan loop skips the output lookup otherwise.
+        for (auto& target : multi.Next) {
+            bool reports = !outputs[target].empty();
+            target *= classes;
+            if (reports)
+                target |= MultiPattern::kHasOutput;
+        }
+
+        multi.OutputStart.reserve(states + 1);
+        for (const auto& list : outputs) {
+            multi.OutputStart.push_back(static_cast<std::uint32_t>(multi.Outputs.size()));
+            multi.Outputs.insert(multi.Outputs.end(), list.begin(), list.end());
+        }
+        multi.OutputStart.push_back(static_cast<std::uint32_t>(multi.Outputs.size()));
+        return multi;
+    }
+
+    using MultiResults = std::vector<std::vector<const std::uint8_t*>>;
+
+    // Walks one region, appending verified hits to results. Returns true once nothing is left to find.
+    inline bool ScanMultiRegion(const MultiPattern& multi, const std::uint8_t* data, std::size_t size, MultiResults& results, std::size_t& remaining, bool wantsAll)
+    {
+        // A DFA step is one dependent load, so a single walk is latency bound. Walk kLanes adjacent
+        // blocks side by side instead; each lane starts MaxKeyword - 1 bytes early to sync its state.
+        // Hits are merged lane by lane after every group, which keeps address order and lets the
+        // early stop happen at group granularity.
+        constexpr std::size_t kLanes = 4;
+        constexpr std::size_t kBlock = 64 * 1024;
+        struct Hit { std::uint32_t Index; const std::uint8_t* Address; };
+        std::array<std::vector<Hit>, kLanes> hits;
+
+        const std::uint8_t* end = data + size;
+        const std::uint32_t* next = multi.Next.data();
+        const std::uint8_t* byteClass = multi.ByteClass.data();
+        const std::size_t warmup = multi.MaxKeyword - 1;
+
+        auto report = [&](std::size_t lane, std::uint32_t target, std::size_t i) {
+            std::uint32_t state = (target & ~MultiPattern::kHasOutput) / multi.Classes;
+            for (std::uint32_t k = multi.OutputStart[state]; k < multi.OutputStart[state + 1]; ++k) {
+                std::uint32_t index = multi.Outputs[k];
+                const auto& entry = multi.Entries[index];
+                if (entry.Wanted == Mode::First && !results[index].empty())
+                    continue;
+
+                std::size_t keywordStart = i + 1 - entry.KeywordSize;
+                if (keywordStart < entry.KeywordOffset)
+                    continue;
+                std::size_t start = keywordStart - entry.KeywordOffset;
+                if (start + entry.Signature.Size <= size && MatchesAt(data + start, end, entry.Signature))
+                    hits[lane].push_back({ index, data + start });
+            }
+        };
+
+        for (std::size_t group = 0; group < size; group += kLanes * kBlock) {
+            std::array<std::size_t, kLanes> pos{}, stop{}, from{};
+            std::array<std::uint32_t, kLanes> state{};
+            for (std::size_t lane = 0; lane < kLanes; ++lane) {
+                from[lane] = std::min(size, group + lane * kBlock);
+                stop[lane] = std::min(size, from[lane] + kBlock);
+                pos[lane] = from[lane] > warmup ? from[lane] - warmup : 0;
+            }
+
+            // Interleaved walk while every lane has bytes left, then finish the stragglers one by one.
+            std::size_t common = stop[0] - pos[0];
+            for (std::size_t lane = 1; lane < kLanes; ++lane)
+                common = std::min(common, stop[lane] - pos[lane]);
+            for (std::size_t step = 0; step < common; ++step) {
+                for (std::size_t lane = 0; lane < kLanes; ++lane) {
+                    std::size_t i = pos[lane] + step;
+                    std::uint32_t target = next[state[lane] + byteClass[data[i]]];
+                    state[lane] = target & ~MultiPattern::kHasOutput;
+                    if ((target & MultiPattern::kHasOutput) && i >= from[lane])
+                        report(lane, target, i);
+                }
+            }
+            for (std::size_t lane = 0; lane < kLanes; ++lane) {
+                for (std::size_t i = pos[lane] + common; i < stop[lane]; ++i) {
+                    std::uint32_t target = next[state[lane] + byteClass[data[i]]];
+                    state[lane] = target & ~MultiPattern::kHasOutput;
+                    if ((target & MultiPattern::kHasOutput) && i >= from[lane])
+                        report(lane, target, i);
+                }
+            }
+
+            for (auto& laneHits : hits) {
+                for (const auto& hit : laneHits) {
+                    if (multi.Entries[hit.Index].Wanted == Mode::First) {
+                        if (!results[hit.Index].empty())
+                            continue;
+                        --remaining;
+                    }
+                    results[hit.Index].push_back(hit.Address);
+                }
+                laneHits.clear();
+            }
+            if (!remaining && !wantsAll)
+                return true;
+        }
+        return false;
+    }
+
+    // Returns one result list per entry, in entry order. Regions must be sorted by address and are
+    // scanned independently (no match spans two regions). Stops early once every Mode::First entry
+    // has been found, unless some entry wants all matches.
+    inline MultiResults ScanMulti(const MultiPattern& multi, const std::vector<Region>& regions)
+    {
+        MultiResults results(multi.Entries.size());
+        std::size_t remaining = 0;
+        bool wantsAll = false;
+        for (std::size_t index = 0; index < multi.Entries.size(); ++index) {
+            const auto& entry = multi.Entries[index];
+            if (!entry.KeywordSize) {
+                // All wildcards, nothing for the automaton to anchor on.
+                if (entry.Wanted == Mode::All)
+                    results[index] = FindAll(regions, entry.Signature);
+                else if (auto match = FindFirst(regions, entry.Signature))
+                    results[index].push_back(match);
+            }
+            else if (entry.Wanted == Mode::All) {
+                wantsAll = true;
+            }
+            else {
+                ++remaining;
+            }
+        }
+        if (!remaining && !wantsAll)
+            return results;
+
+        for (const auto& region : regions) {
+            if (ScanMultiRegion(multi, region.Data, region.Size, results, remaining, wantsAll))
+                break;
+        }
+        return results;
+    }
+
+    inline MultiResults ScanMulti(const MultiPattern& multi, const std::uint8_t* data, std::size_t size)
+    {
+        return ScanMulti(multi, std::vector<Region>{ { data, size } });
+    }
+
+    // Persistent pool for parallel scans. Run() hands the same job to `threads` workers, the calling
+    // thread acting as worker 0, and returns once all of them are done. Workers are never torn down
+    // by the pool itself so nothing has to be joined while the loader lock is held at unload, Stop()
+    // ends them when the DLL unloads itself.
+    class WorkerPool
+    {
+    public:
+        static WorkerPool& Get()
+        {
+            static WorkerPool* pool = new WorkerPool();
+            return *pool;
+        }
+
+        void Run(unsigned threads, const std::function<void(unsigned)>& job)
+        {
+            if (threads <= 1) {
+                job(0);
+                return;
+            }
+
+            std::scoped_lock runLock(runMutex);
+            {
+                std::scoped_lock lock(mutex);
+                while (workers.size() < threads - 1) {
+                    auto id = static_cast<unsigned>(workers.size() + 1);
+                    workers.emplace_back([this, id] { Loop(id); });
+                }
+                current = &job;
+                participants = threads - 1;
+                active = threads - 1;
+                ++generation;
+            }
+            wake.notify_all();
+
+            job(0);
+
+            std::unique_lock lock(mutex);
+            done.wait(lock, [&] { return active == 0; });
+            current = nullptr;
+        }
+
+        // Ends and joins the workers, so no thread is left running in the DLL's code when it
+        // unloads itself (FreeLibraryAndExitThread). Not with the loader lock held. A later Run()
+        // starts new workers.
+        void Stop()
+        {
+            std::scoped_lock runLock(runMutex);
+            {
+                std::scoped_lock lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (auto& worker : workers)
+                worker.join();
+            workers.clear();
+
+            std::scoped_lock lock(mutex);
+            stopping = false;
+        }
+
+    private:
+        std::mutex runMutex;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+        const std::function<void(unsigned)>* current = nullptr;
+        std::uint64_t generation = 0;
+        std::vector<std::thread> workers;   // Only touched with runMutex held
+        bool stopping = false;
+        unsigned participants = 0;
+        unsigned active = 0;
+
+        void Loop(unsigned id)
+        {
+            std::uint64_t seen = 0;
+            std::unique_lock lock(mutex);
+            for (;;) {
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+                if (id > participants)
+                    continue;
+
+                const auto* job = current;
+                lock.unlock();
+                (*job)(id);
+                lock.lock();
+                if (--active == 0)
+                    done.notify_one();
+            }
+        }
+    };
+
+    // Chunk indices owned by one worker, packed as front << 32 | back. The owner pops from the front,
+    // idle workers steal from the back.
+    struct alignas(64) ChunkQueue
+    {
+        std::atomic<std::uint64_t> Bounds{ 0 };
+
+        bool PopFront(std::uint32_t& chunk)
+        {
+            std::uint64_t bounds = Bounds.load(std::memory_order_relaxed);
+            for (;;) {
+                auto front = static_cast<std::uint32_t>(bounds >> 32);
+                auto back = static_cast<std::uint32_t>(bounds);
+                if (front >= back)
+                    return false;
+                if (Bounds.compare_exchange_weak(bounds, (static_cast<std::uint64_t>(front + 1) << 32) | back)) {
+                    chunk = front;
+                    return true;
+                }
+            }
+        }
+
+        bool PopBack(std::uint32_t& chunk)
+        {
+            std::uint64_t bounds = Bounds.load(std::memory_order_relaxed);
+            for (;;) {
+                auto front = static_cast<std::uint32_t>(bounds >> 32);
+                auto back = static_cast<std::uint32_t>(bounds);
+                if (front >= back)
+                    return false;
+                if (Bounds.compare_exchange_weak(bounds, (static_cast<std::uint64_t>(front) << 32) | (back - 1))) {
+                    chunk = back - 1;
+                    return true;
+                }
+            }
+        }
+    };
+
+    inline unsigned DefaultThreads()
+    {
+        return std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+    }
+
+    // Calls fn(chunk) exactly once for every chunk in [0, count), spread over up to `threads` workers.
+    template <typename Fn>
+    void RunChunks(std::size_t count, unsigned threads, Fn&& fn)
+    {
+        threads = static_cast<unsigned>(std::clamp<std::size_t>(threads, 1, std::max<std::size_t>(count, 1)));
+        if (threads == 1) {
+            for (std::size_t chunk = 0; chunk < count; ++chunk)
+                fn(chunk);
+            return;
+        }
+
+        // Each worker starts on its own contiguous slice so neighbouring chunks stay on one core.
+        auto queues = std::make_unique<ChunkQueue[]>(threads);
+        for (unsigned worker = 0; worker < threads; ++worker) {
+            auto front = static_cast<std::uint64_t>(count * worker / threads);
+            auto back = static_cast<std::uint64_t>(count * (worker + 1) / threads);
+            queues[worker].Bounds.store((front << 32) | back, std::memory_order_relaxed);
+        }
+
+        WorkerPool::Get().Run(threads, [&](unsigned self) {
+            std::uint32_t chunk;
+            while (queues[self].PopFront(chunk))
+                fn(chunk);
+            for (unsigned step = 1; step < threads; ++step) {
+                auto& victim = queues[(self + step) % threads];
+                while (victim.PopBack(chunk))
+                    fn(chunk);
+            }
+        });
+    }
+
+    // A slice of one region. Matches must start in [Begin, End), the scan window extends past End
+    // by the pattern length so matches straddling the boundary are still seen.
+    struct Chunk
+    {
+        std::size_t Region;
+        std::size_t Begin;
+        std::size_t End;
+    };
+
+    constexpr std::size_t kChunkSize = 1024 * 1024;
+
+    inline std::vector<Chunk> MakeChunks(const std::vector<Region>& regions)
+    {
+        std::vector<Chunk> chunks;
+        for (std::size_t index = 0; index < regions.size(); ++index) {
+            for (std::size_t begin = 0; begin < regions[index].Size; begin += kChunkSize)
+                chunks.push_back({ index, begin, std::min(begin + kChunkSize, regions[index].Size) });
+        }
+        return chunks;
+    }
+
+    inline Region ChunkWindow(const std::vector<Region>& regions, const Chunk& chunk, std::size_t patternSize)
+    {
+        const Region& region = regions[chunk.Region];
+        std::size_t end = std::min(region.Size, chunk.End + (patternSize ? patternSize - 1 : 0));
+        return { region.Data + chunk.Begin, end - chunk.Begin };
+    }
+
+    // Parallel versions below return exactly what the serial scans over the same regions return.
+    inline const std::uint8_t* FindFirstParallel(const std::vector<Region>& regions, const Pattern& pattern, unsigned threads = DefaultThreads())
+    {
+        auto chunks = MakeChunks(regions);
+        std::vector<const std::uint8_t*> found(chunks.size(), nullptr);
+        std::atomic<std::size_t> firstHit{ chunks.size() };
+
+        RunChunks(chunks.size(), threads, [&](std::size_t index) {
+            // A lower chunk already matched, nothing here can be the first match.
+            if (index > firstHit.load(std::memory_order_relaxed))
+                return;
+
+            Region window = ChunkWindow(regions, chunks[index], pattern.Size);
+            found[index] = FindFirst(window.Data, window.Size, pattern);
+            if (found[index]) {
+                std::size_t current = firstHit.load(std::memory_order_relaxed);
+                while (index < current && !firstHit.compare_exchange_weak(current, index)) {}
+            }
+        });
+
+        for (const std::uint8_t* match : found) {
+            if (match)
+                return match;
+        }
+        return nullptr;
+    }
+
+    inline std::vector<const std::uint8_t*> FindAllParallel(const std::vector<Region>& regions, const Pattern& pattern, unsigned threads = DefaultThreads())
+    {
+        auto chunks = MakeChunks(regions);
+        std::vector<std::vector<const std::uint8_t*>> found(chunks.size());
+
+        RunChunks(chunks.size(), threads, [&](std::size_t index) {
+            Region window = ChunkWindow(regions, chunks[index], pattern.Size);
+            found[index] = FindAll(window.Data, window.Size, pattern);
+        });
+
+        std::vector<const std::uint8_t*> results;
+        for (const auto& matches : found)
+            results.insert(results.end(), matches.begin(), matches.end());
+        return results;
+    }
+
+    inline MultiResults ScanMultiParallel(const MultiPattern& multi, const std::vector<Region>& regions, unsigned threads = DefaultThreads())
+    {
+        std::size_t firstEntries = 0;
+        std::size_t maxSize = 0;
+        bool wantsAll = false;
+        for (const auto& entry : multi.Entries) {
+            if (!entry.KeywordSize)
+                continue;
+            maxSize = std::max(maxSize, entry.Signature.Size);
+            if (entry.Wanted == Mode::All)
+                wantsAll = true;
+            else
+                ++firstEntries;
+        }
+
+        auto chunks = MakeChunks(regions);
+        std::vector<MultiResults> found(chunks.size());
+        // Lowest chunk each Mode::First entry has matched in so far.
+        auto firstChunk = std::make_unique<std::atomic<std::size_t>[]>(multi.Entries.size());
+        for (std::size_t entry = 0; entry < multi.Entries.size(); ++entry)
+            firstChunk[entry].store(chunks.size(), std::memory_order_relaxed);
+
+        RunChunks(chunks.size(), threads, [&](std::size_t index) {
+            // Every first-match entry already matched in a lower chunk, this one can't change the result.
+            if (!wantsAll) {
+                bool needed = false;
+                for (std::size_t entry = 0; entry < multi.Entries.size() && !needed; ++entry) {
+                    const auto& e = multi.Entries[entry];
+                    needed = e.KeywordSize && firstChunk[entry].load(std::memory_order_relaxed) > index;
+                }
+                if (!needed)
+                    return;
+            }
+
+            const Chunk& chunk = chunks[index];
+            Region window = ChunkWindow(regions, chunk, maxSize);
+            const std::uint8_t* limit = regions[chunk.Region].Data + chunk.End;
+
+            MultiResults local(multi.Entries.size());
+            std::size_t remaining = firstEntries;
+            ScanMultiRegion(multi, window.Data, window.Size, local, remaining, wantsAll);
+
+            for (std::size_t entry = 0; entry < local.size(); ++entry) {
+                auto& matches = local[entry];
+                // Matches starting past the chunk belong to the next chunk.
+                matches.erase(std::lower_bound(matches.begin(), matches.end(), limit), matches.end());
+                if (!matches.empty() && multi.Entries[entry].Wanted == Mode::First) {
+                    std::size_t current = firstChunk[entry].load(std::memory_order_relaxed);
+                    while (index < current && !firstChunk[entry].compare_exchange_weak(current, index)) {}
+                }
+            }
+            found[index] = std::move(local);
+        });
+
+        // Entries with no solid bytes never reach the automaton, resolve them like the serial scan does.
+        MultiResults results(multi.Entries.size());
+        for (std::size_t entry = 0; entry < multi.Entries.size(); ++entry) {
+            const auto& e = multi.Entries[entry];
+            if (!e.KeywordSize) {
+                if (e.Wanted == Mode::All)
+                    results[entry] = FindAll(regions, e.Signature);
+                else if (auto match = FindFirst(regions, e.Signature))
+                    results[entry].push_back(match);
+                continue;
+            }
+
+            for (const auto& local : found) {
+                if (local.empty() || local[entry].empty())
+                    continue;
+                if (e.Wanted == Mode::First) {
+                    results[entry].push_back(local[entry].front());
+                    break;
+                }
+                results[entry].insert(results[entry].end(), local[entry].begin(), local[entry].end());
+            }
+        }
+        return results;
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "scanner.hpp"
+
+#include <charconv>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Resolved signature RVAs saved between launches, one line per (exe name, timestamp, signature hash):
+//   <exe name> <timestamp> <signature hash> <rva>[,<rva>...]
+// All values are hex, the hash covers the parsed bytes, mask and scan mode rather than the signature text. Only hits are stored, a missing signature is simply scanned for again.
+namespace SigCache
+{
+    // FNV-1a over the solid bytes, mask and mode, so only the matching semantics of a signature count.
+    // The mode keeps a first-match signature and an all-matches one with the same pattern apart.
+    constexpr std::uint64_t Hash(const Scanner::Pattern& pattern, Scanner::Mode mode)
+    {
+        std::uint64_t hash = 0xCBF29CE484222325ull;
+        auto mix = [&](std::uint8_t byte) {
+            hash ^= byte;
+            hash *= 0x100000001B3ull;
+        };
+        mix(static_cast<std::uint8_t>(mode));
+        for (std::size_t i = 0; i < pattern.Size; ++i) {
+            mix(pattern.Mask[i]);
+            mix(pattern.Bytes[i] & pattern.Mask[i]);
+        }
+        return hash;
+    }
+
+    class Cache
+    {
+    public:
+        Cache(std::filesystem::path path, std::string exeName, std::uint32_t timestamp)
+            : path(std::move(path)), exeName(std::move(exeName)), timestamp(timestamp)
+        {
+        }
+
+        // Reads entries for this exe build, lines for other exes or builds are kept for Save().
+        void Load()
+        {
+            std::ifstream file(path);
+            std::string line;
+            while (std::getline(file, line)) {
+                std::istringstream fields(line);
+                std::string name, rvas;
+                std::uint32_t lineTimestamp = 0;
+                std::uint64_t hash = 0;
+                if (!(fields >> name >> std::hex >> lineTimestamp >> hash >> rvas))
+                    continue;
+
+                if (name != exeName) {
+                    foreign.push_back(line);
+                    continue;
+                }
+                // Stale builds of this exe are dropped.
+                if (lineTimestamp != timestamp)
+                    continue;
+
+                std::vector<std::uint32_t> parsed;
+                const char* cursor = rvas.data();
+                const char* end = rvas.data() + rvas.size();
+                while (cursor < end) {
+                    std::uint32_t rva = 0;
+                    auto [next, error] = std::from_chars(cursor, end, rva, 16);
+                    if (error != std::errc{})
+                        break;
+                    parsed.push_back(rva);
+                    cursor = next + (next < end && *next == ',');
+                }
+                if (!parsed.empty() && cursor == end)
+                    entries[hash] = std::move(parsed);
+            }
+        }
+
+        const std::vector<std::uint32_t>* Find(const Scanner::Pattern& signature, Scanner::Mode mode) const
+        {
+            auto entry = entries.find(Hash(signature, mode));
+            return entry == entries.end() ? nullptr : &entry->second;
+        }
+
+        void Store(const Scanner::Pattern& signature, Scanner::Mode mode, std::vector<std::uint32_t> rvas)
+        {
+            if (rvas.empty())
+                entries.erase(Hash(signature, mode));
+            else
+                entries[Hash(signature, mode)] = std::move(rvas);
+            dirty = true;
+        }
+
+        bool Dirty() const { return dirty; }
+
+        bool Save()
+        {
+            std::ofstream file(path, std::ios::trunc);
+            if (!file)
+                return false;
+
+            for (const auto& line : foreign)
+                file << line << '\n';
+            for (const auto& [hash, rvas] : entries) {
+                file << exeName << std::hex << ' ' << timestamp << ' ' << hash << ' ';
+                for (std::size_t i = 0; i < rvas.size(); ++i)
+                    file << (i ? "," : "") << rvas[i];
+                file << std::dec << '\n';
+            }
+            dirty = false;
+            return static_cast<bool>(file);
+        }
+
+    private:
+        std::filesystem::path path;
+        std::string exeName;
+        std::uint32_t timestamp;
+        std::map<std::uint64_t, std::vector<std::uint32_t>> entries;
+        std::vector<std::string> foreign;
+        bool dirty = false;
+    };
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "scanner.hpp"
+
+#include <cstdint>
+
+enum class Game
+{
+    Unknown,
+    TPP,      // MGS V: The Phantom Pain
+    GZ,       // MGS V: Ground Zeroes
+};
+
+namespace Signatures
+{
+    using namespace Scanner::Literals;
+
+    enum GameMask : std::uint8_t
+    {
+        InGZ = 1 << 0,
+        InTPP = 1 << 1,
+        InBoth = InGZ | InTPP,
+    };
+
+    struct Signature
+    {
+        const char* Name;
+        Scanner::Pattern Pattern;
+        std::uint8_t Games;
+        bool All = false;   // Every match is needed, not just the first
+    };
+
+    constexpr bool AppliesTo(const Signature& signature, Game game)
+    {
+        return (game == Game::GZ && (signature.Games & InGZ)) || (game == Game::TPP && (signature.Games & InTPP));
+    }
+
+    // Resolution
+    inline constexpr Signature CurrentResolution        { "GZ/TPP: Current Resolution", "48 89 ?? ?? 48 8B ?? ?? 48 ?? ?? ?? ?? ?? ?? ?? ?? B8 01 00 00 00 48 ?? ?? ??"_sig, InBoth };
+    inline constexpr Signature WindowedResolutions      { "GZ/TPP: Unlock Resolutions: Windowed", "72 ?? 0F ?? ?? 73 ?? 80 ?? ?? 00 74 ?? 0F ?? ?? 73 ?? F3 0F ?? ??"_sig, InBoth };
+    inline constexpr Signature BorderlessTopMost        { "GZ: Borderless TopMost", "C7 44 ?? ?? ?? ?? ?? ?? 89 ?? ?? ?? 8B ?? ?? 89 ?? ?? ?? FF ?? ?? ?? ?? ?? E9 ?? ?? ?? ??"_sig, InGZ };
+    inline constexpr Signature FullscreenResolutionsGZ  { "GZ: Unlock Resolutions: Fullscreen/Borderless", "F3 0F ?? ?? F3 48 ?? ?? ?? 8B ?? 41 ?? ?? ?? ?? ?? ?? 0F ?? ?? 44 ?? ?? 41 ?? ?? ?? 41 ?? ?? 33 ??"_sig, InGZ };
+    inline constexpr Signature FullscreenResolutionsTPP { "TPP: Unlock Resolutions: Fullscreen/Borderless", "F3 0F ?? ?? F3 48 ?? ?? ?? B8 ?? ?? ?? ?? 89 ?? 39 ?? 0F ?? ?? 89 ?? ?? ?? 39 ??"_sig, InTPP };
+    inline constexpr Signature IntroLogos               { "TPP: Intro Logos", "C6 ?? ?? ?? ?? ?? 01 C7 ?? ?? ?? ?? ?? 00 00 00 00 E8 ?? ?? ?? ?? C7 ?? 00 00 00 00 48 89 ??"_sig, InTPP };
+
+    // Aspect ratio
+    inline constexpr Signature ThrowableMarker          { "GZ/TPP: Throwable Marker", "E8 ?? ?? ?? ?? F3 0F ?? ?? ?? ?? 66 0F ?? ?? 66 0F ?? ?? 41 ?? ?? ?? 4C ?? ?? ?? ?? BA 01 00 00 00"_sig, InBoth };
+    inline constexpr Signature LensEffects              { "GZ/TPP: Lens Effects", "0F 28 ?? F3 ?? 0F ?? ?? ?? ?? ?? ?? F3 45 ?? ?? ?? ?? F3 45 ?? ?? ?? F3 44 ?? ?? ?? ?? E8 ?? ?? ?? ??"_sig, InBoth };
+    inline constexpr Signature DepthOfFieldGZ           { "GZ: Depth of Field", "F3 0F ?? ?? ?? ?? ?? ?? 0F ?? ?? 0F ?? ?? ?? ?? ?? ?? 44 0F ?? ?? F3 44 ?? ?? ??"_sig, InGZ };
+    inline constexpr Signature DepthOfFieldTPP          { "TPP: Depth of Field", "F3 0F ?? ?? ?? ?? ?? ?? 0F ?? ?? 0F ?? ?? 0F ?? ?? 0F ?? ?? ?? 0F ?? ?? ?? 0F ?? ?? ?? 44 0F ?? ??"_sig, InTPP };
+
+    // HUD
+    inline constexpr Signature HUDBackgroundsGZ         { "GZ: HUD: Backgrounds", "41 0F ?? ?? 8B ?? ?? F6 ?? ?? 0F 84 ?? ?? ?? ?? 44 ?? ?? 41 ?? ?? ?? 41 ?? ?? ?? 74 ??"_sig, InGZ };
+    inline constexpr Signature HUDBackgroundsTPP        { "TPP: HUD: Backgrounds", "F6 41 ?? 01 74 ?? 0F ?? ?? ?? 0F ?? ?? ?? 44 0F ?? ?? ?? 41 ?? ?? ??"_sig, InTPP };
+    inline constexpr Signature Markers                  { "TPP: HUD: Markers", "48 81 ?? ?? ?? ?? ?? E9 ?? ?? ?? ?? 48 8B ?? ?? ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ??"_sig, InTPP };
+    inline constexpr Signature MarkerConstraint         { "TPP: HUD: Marker Constraint", "F3 0F ?? ?? ?? ?? ?? ?? 0F ?? ?? 77 ?? F3 0F ?? ?? ?? ?? ?? ?? 0F ?? ?? 73 ?? 0F ?? ?? E8 ?? ?? ?? ??"_sig, InTPP };
+    inline constexpr Signature Overlays                 { "TPP: HUD: Overlays", "F3 0F ?? ?? ?? ?? ?? ?? C7 44 ?? ?? 00 00 80 BF C7 44 ?? ?? 00 00 80 3F"_sig, InTPP, true };
+    inline constexpr Signature SonarMarkers             { "TPP: HUD: Sonar Markers", "F3 0F ?? ?? ?? ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ?? F3 0F ?? ?? F3 0F ?? ?? ?? 48 83 ?? ??"_sig, InTPP };
+
+    // Movies
+    inline constexpr Signature MovieFrame               { "TPP: HUD: Movie Frame", "72 ?? 44 0F ?? ?? 72 ?? 41 0F ?? ?? F3 41 ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ?? 0F ?? ?? 76 ??"_sig, InTPP };
+    inline constexpr Signature MovieStatus              { "TPP: HUD: Movie Status", "8B ?? ?? ?? ?? ?? FF ?? 0F 84 ?? ?? ?? ?? FF ?? 0F 84 ?? ?? ?? ?? FF ?? 74 ?? 48 8D ?? ?? ?? ?? ?? 33 ??"_sig, InTPP };
+    inline constexpr Signature MovieViewport            { "TPP: HUD: Viewport", "F3 0F ?? ?? F3 0F ?? ?? 0F ?? ?? 73 ?? 41 0F ?? ?? 41 ?? ?? 44 ?? ?? F3 0F ?? ?? F3 0F ?? ??"_sig, InTPP };
+
+    // Framerate
+    inline constexpr Signature FramerateSetting         { "GZ/TPP: Framerate: Setting", "48 33 ?? ?? ?? ?? ?? 49 85 ?? 48 0F ?? ?? ?? ?? ?? ?? 48 89 ?? ?? ?? ??"_sig, InBoth };
+    inline constexpr Signature FramerateTarget          { "GZ/TPP: Framerate: Target", "49 85 ?? 75 ?? F2 0F 10 0D ?? ?? ?? ??"_sig, InBoth };
+    inline constexpr Signature ThreadSleep              { "GZ/TPP: Thread Sleep", "48 ?? ?? 48 85 ?? 75 ?? 8D ?? 01 48 8D ?? ?? ??"_sig, InBoth };
+    inline constexpr Signature ThrowableBug             { "GZ: Framerate: Throwable Framerate Bug", "F2 0F 59 ?? ?? ?? ?? ?? 66 0F ?? ?? F7 ?? ?? ?? ?? ?? 00 01 00 00 74 ??"_sig, InGZ };
+
+    // Graphics
+    inline constexpr Signature LODFactorResolutionTPP   { "TPP: Graphics: LOD: LOD Factor Resolution", "8B ?? ?? ?? ?? ?? 4C 8B ?? ?? ?? ?? ?? 85 ?? 75 ?? 8B ?? ?? ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ?? F3 0F ?? ?? ?? ?? ?? ??"_sig, InTPP };
+    inline constexpr Signature LODFactorResolutionGZ    { "GZ: Graphics: LOD: LOD Factor Resolution", "66 0F ?? ?? ?? ?? ?? ?? 0F 29 ?? ?? 0F 28 ?? F3 0F ?? ?? ?? ?? ?? ?? 0F 5B ??"_sig, InGZ };
+    inline constexpr Signature ModelQuality             { "GZ/TPP: Graphics: LOD: Model/Grass LOD Distance", "89 ?? 64 B0 01 C3 8B ?? ?? C6 ?? ?? 00 89 ?? ?? B0 01 C3"_sig, InBoth };
+
+    // Signatures scanned together at startup. IntroLogos is left out while IntroSkip is disabled, it
+    // falls back to its own scan if it's used.
+    inline constexpr const Signature* kAll[] = {
+        &CurrentResolution, &WindowedResolutions, &BorderlessTopMost, &FullscreenResolutionsGZ, &FullscreenResolutionsTPP,
+        &ThrowableMarker, &LensEffects, &DepthOfFieldGZ, &DepthOfFieldTPP,
+        &HUDBackgroundsGZ, &HUDBackgroundsTPP, &Markers, &MarkerConstraint, &Overlays, &SonarMarkers,
+        &MovieFrame, &MovieStatus, &MovieViewport,
+        &FramerateSetting, &FramerateTarget, &ThreadSleep, &ThrowableBug,
+        &LODFactorResolutionTPP, &LODFactorResolutionGZ, &ModelQuality,
+    };
+}
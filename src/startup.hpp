@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+// Startup as a small dependency graph. Every stage whose dependencies have finished is started on
+// its own thread, so independent work (e.g. parsing the ini and scanning the exe) overlaps.
+namespace Startup
+{
+    using Clock = std::chrono::steady_clock;
+
+    class Pipeline
+    {
+    public:
+        // Times in the report are relative to origin, normally when the DLL was loaded.
+        explicit Pipeline(Clock::time_point origin) : origin(origin) {}
+
+        // A stage returning false fails, and every stage depending on it is skipped.
+        // Dependencies have to be added first. A stage naming one that wasn't is skipped too, rather
+        // than run without its ordering.
+        void Add(const char* name, std::initializer_list<const char*> after, std::function<bool()> run)
+        {
+            Stage stage{ name, {}, std::move(run) };
+            for (const char* dependency : after) {
+                auto found = std::find_if(stages.begin(), stages.end(), [&](const Stage& added) { return std::string_view(added.Name) == dependency; });
+                if (found == stages.end()) {
+                    spdlog::error("Startup: {:s}: Depends on unknown stage \"{:s}\", skipping it.", name, dependency);
+                    assert(!"Startup stage depends on a stage that hasn't been added");
+                    stage.State = Status::Skipped;
+                    continue;
+                }
+                stage.After.push_back(static_cast<std::size_t>(found - stages.begin()));
+            }
+            stages.push_back(std::move(stage));
+        }
+
+        // Returns once every stage has finished or been skipped.
+        void Run()
+        {
+            std::vector<std::thread> threads;
+            std::unique_lock lock(mutex);
+            for (;;) {
+                bool running = false;
+                for (std::size_t i = 0; i < stages.size(); ++i) {
+                    Stage& stage = stages[i];
+                    if (stage.State == Status::Running)
+                        running = true;
+                    if (stage.State != Status::Waiting)
+                        continue;
+
+                    bool ready = true;
+                    for (std::size_t dependency : stage.After) {
+                        Status state = stages[dependency].State;
+                        if (state == Status::Failed || state == Status::Skipped) {
+                            stage.State = Status::Skipped;
+                            ready = false;
+                            break;
+                        }
+                        ready &= state == Status::Done;
+                    }
+                    if (!ready)
+                        continue;
+
+                    stage.State = Status::Running;
+                    stage.Start = Clock::now();
+                    running = true;
+                    threads.emplace_back([this, i] {
+                        bool result = stages[i].Run();
+                        std::scoped_lock lock(mutex);
+                        stages[i].End = Clock::now();
+                        stages[i].State = result ? Status::Done : Status::Failed;
+                        finished.notify_one();
+                    });
+                }
+                if (!running)
+                    break;
+                finished.wait(lock);
+            }
+            lock.unlock();
+
+            for (auto& thread : threads)
+                thread.join();
+        }
+
+        bool Succeeded(std::string_view name) const
+        {
+            for (const auto& stage : stages) {
+                if (stage.Name == name)
+                    return stage.State == Status::Done;
+            }
+            return false;
+        }
+
+        // Milliseconds from origin until the stage finished, or a negative value if it didn't.
+        double FinishedAt(std::string_view name) const
+        {
+            for (const auto& stage : stages) {
+                if (stage.Name == name && stage.State == Status::Done)
+                    return Milliseconds(stage.End - origin);
+            }
+            return -1.0;
+        }
+
+        void Report() const
+        {
+            for (const auto& stage : stages) {
+                switch (stage.State) {
+                case Status::Done:
+                case Status::Failed:
+                    spdlog::info("Startup: {:s}: {:s} at {:.2f}ms, took {:.2f}ms.", stage.Name, stage.State == Status::Done ? "Started" : "Failed, started", Milliseconds(stage.Start - origin), Milliseconds(stage.End - stage.Start));
+                    break;
+                default:
+                    spdlog::info("Startup: {:s}: Skipped.", stage.Name);
+                    break;
+                }
+            }
+        }
+
+    private:
+        enum class Status
+        {
+            Waiting,
+            Running,
+            Done,
+            Failed,
+            Skipped,
+        };
+
+        struct Stage
+        {
+            const char* Name;
+            std::vector<std::size_t> After;
+            std::function<bool()> Run;
+            Status State = Status::Waiting;
+            Clock::time_point Start{};
+            Clock::time_point End{};
+        };
+
+        static double Milliseconds(Clock::duration duration)
+        {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+
+        Clock::time_point origin;
+        std::vector<Stage> stages;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+}
@@ -3,8 +3,14 @@
 #define WIN32_LEAN_AND_MEAN
 
 #include <windows.h>
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <fstream>
 #include <filesystem>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
 #include <vector>
 #include <winternl.h>
\ No newline at end of file
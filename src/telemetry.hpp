@@ -0,0 +1,321 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <spdlog/spdlog.h>
+
+// Frame times measured at the main thread's per-frame sleep. Frame() is called once per frame and
+// only touches fixed arrays with relaxed atomics, a reporter thread turns them into CSV rows and
+// hitch reports. Hooks are tagged so a hitch can say which hooks ran during that frame. Code caves
+// run no callback to tag, so they're only listed as untracked.
+namespace Telemetry
+{
+    constexpr std::size_t kMaxHooks = 64;
+    constexpr std::size_t kMedianWindow = 63;
+    constexpr std::size_t kMaxHitches = 64;    // Per report interval, extras are only counted
+    constexpr std::uint64_t kHitchFactor = 2;
+
+    // Log-linear histogram over microseconds: exact below 32, then 32 buckets per power of two
+    // (~3% resolution) up to 2^26us, plus one overflow bucket.
+    constexpr std::size_t kSubBits = 5;
+    constexpr std::size_t kSubBuckets = std::size_t(1) << kSubBits;
+    constexpr std::size_t kMaxExponent = 26;
+    constexpr std::size_t kBuckets = kSubBuckets + (kMaxExponent - kSubBits) * kSubBuckets + 1;
+
+    constexpr std::size_t Bucket(std::uint64_t micros)
+    {
+        if (micros < kSubBuckets)
+            return static_cast<std::size_t>(micros);
+        std::size_t exponent = std::bit_width(micros) - 1;
+        if (exponent >= kMaxExponent)
+            return kBuckets - 1;
+        return kSubBuckets + (exponent - kSubBits) * kSubBuckets + ((micros >> (exponent - kSubBits)) & (kSubBuckets - 1));
+    }
+
+    // [low, high] microseconds covered by a bucket.
+    constexpr std::uint64_t BucketLow(std::size_t bucket)
+    {
+        if (bucket < kSubBuckets)
+            return bucket;
+        std::size_t exponent = (bucket - kSubBuckets) / kSubBuckets + kSubBits;
+        std::uint64_t sub = (bucket - kSubBuckets) % kSubBuckets;
+        return (kSubBuckets + sub) << (exponent - kSubBits);
+    }
+
+    constexpr std::uint64_t BucketHigh(std::size_t bucket)
+    {
+        return bucket + 1 < kBuckets ? BucketLow(bucket + 1) - 1 : BucketLow(bucket);
+    }
+
+    struct Hitch
+    {
+        std::uint64_t Frame;
+        std::uint64_t Micros;
+        std::uint64_t MedianMicros;
+        std::uint64_t Hooks;        // Bit per registered hook
+    };
+
+    struct State
+    {
+        std::atomic<bool> Enabled{ false };
+
+        // Written by hooks on any thread, swapped out at each frame boundary.
+        alignas(64) std::atomic<std::uint64_t> Fired{ 0 };
+
+        // Written by the main thread only.
+        alignas(64) std::array<std::atomic<std::uint32_t>, kBuckets> Buckets{};
+        std::atomic<std::uint64_t> Frames{ 0 };
+        std::atomic<std::uint64_t> TotalMicros{ 0 };
+        std::chrono::steady_clock::time_point LastFrame{};
+        std::array<std::uint64_t, kMedianWindow> Window{};
+        std::size_t WindowFill = 0;
+        std::size_t WindowNext = 0;
+
+        // Single producer (main thread), single consumer (reporter).
+        std::array<Hitch, kMaxHitches> Hitches{};
+        std::atomic<std::size_t> HitchHead{ 0 };
+        std::atomic<std::size_t> HitchTail{ 0 };
+        std::atomic<std::uint64_t> HitchesDropped{ 0 };
+
+        std::array<const char*, kMaxHooks> Names{};
+        std::atomic<std::size_t> HookCount{ 0 };
+
+        std::array<const char*, kMaxHooks> UntrackedNames{};
+        std::atomic<std::size_t> UntrackedCount{ 0 };
+    };
+
+    inline State& Get()
+    {
+        static State* state = new State();
+        return *state;
+    }
+
+    // Returns the hook's bit index, or kMaxHooks (untracked) once the table is full. Hooks are
+    // registered while the fixes run, before anything reads the names.
+    inline std::size_t Register(const char* name)
+    {
+        State& state = Get();
+        std::size_t id = state.HookCount.load(std::memory_order_relaxed);
+        if (id == kMaxHooks)
+            return kMaxHooks;
+        state.Names[id] = name;
+        state.HookCount.store(id + 1, std::memory_order_release);
+        return id;
+    }
+
+    // For hooks that can't mark themselves (code caves), so hitch reports can say they weren't
+    // tracked rather than leave them out silently. Repeats and names past the table's size are dropped.
+    inline void RegisterUntracked(const char* name)
+    {
+        State& state = Get();
+        std::size_t id = state.UntrackedCount.load(std::memory_order_relaxed);
+        auto names = state.UntrackedNames.begin();
+        if (id == kMaxHooks || std::find(names, names + id, std::string_view(name)) != names + id)
+            return;
+        state.UntrackedNames[id] = name;
+        state.UntrackedCount.store(id + 1, std::memory_order_release);
+    }
+
+    inline void Mark(std::size_t id)
+    {
+        State& state = Get();
+        if (id >= kMaxHooks || !state.Enabled.load(std::memory_order_relaxed))
+            return;
+
+        // Most hooks fire many times a frame, skip the RMW once the bit is set.
+        std::uint64_t bit = std::uint64_t(1) << id;
+        if (!(state.Fired.load(std::memory_order_relaxed) & bit))
+            state.Fired.fetch_or(bit, std::memory_order_relaxed);
+    }
+
+    // Wraps a captureless hook callback so it marks itself as fired. The result is another
+    // captureless lambda, so it can be wrapped again (e.g. by Profiler::Wrap).
+    template <typename Context, typename Fn>
+    auto Wrap(Fn, const char* name)
+    {
+        static std::size_t id = Register(name);
+        return [](Context& ctx) {
+            Mark(id);
+            Fn{}(ctx);
+        };
+    }
+
+    // Called by the main thread once per frame.
+    inline void Frame()
+    {
+        State& state = Get();
+        if (!state.Enabled.load(std::memory_order_relaxed))
+            return;
+
+        auto now = std::chrono::steady_clock::now();
+        std::uint64_t hooks = state.Fired.exchange(0, std::memory_order_relaxed);
+        if (state.LastFrame == std::chrono::steady_clock::time_point{}) {
+            state.LastFrame = now;
+            return;
+        }
+
+        auto micros = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now - state.LastFrame).count());
+        state.LastFrame = now;
+
+        auto bump = [](auto& value, auto amount) {
+            value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        };
+        bump(state.Buckets[Bucket(micros)], 1u);
+        bump(state.TotalMicros, micros);
+        std::uint64_t frame = state.Frames.load(std::memory_order_relaxed) + 1;
+        state.Frames.store(frame, std::memory_order_relaxed);
+
+        // Rolling median of the previous frames, the current one is compared before it joins.
+        if (state.WindowFill == kMedianWindow) {
+            std::array<std::uint64_t, kMedianWindow> sorted = state.Window;
+            auto middle = sorted.begin() + kMedianWindow / 2;
+            std::nth_element(sorted.begin(), middle, sorted.end());
+            if (micros > *middle * kHitchFactor) {
+                std::size_t head = state.HitchHead.load(std::memory_order_relaxed);
+                if (head - state.HitchTail.load(std::memory_order_acquire) < kMaxHitches) {
+                    state.Hitches[head % kMaxHitches] = { frame, micros, *middle, hooks };
+                    state.HitchHead.store(head + 1, std::memory_order_release);
+                }
+                else {
+                    state.HitchesDropped.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+        state.Window[state.WindowNext] = micros;
+        state.WindowNext = (state.WindowNext + 1) % kMedianWindow;
+        state.WindowFill = std::min(state.WindowFill + 1, kMedianWindow);
+    }
+
+    struct Summary
+    {
+        std::uint64_t Frames = 0;
+        double AverageMs = 0.0;
+        double P50Ms = 0.0;
+        double P99Ms = 0.0;
+        double P999Ms = 0.0;
+        double OnePercentLowFps = 0.0;  // Average FPS over the slowest 1% of frames
+    };
+
+    // Percentiles use each bucket's upper bound, so they never under-report.
+    inline Summary Summarise(const std::array<std::uint64_t, kBuckets>& buckets, std::uint64_t frames, std::uint64_t totalMicros)
+    {
+        Summary summary;
+        summary.Frames = frames;
+        if (!frames)
+            return summary;
+
+        summary.AverageMs = double(totalMicros) / double(frames) / 1000.0;
+        auto percentile = [&](double fraction) {
+            auto rank = static_cast<std::uint64_t>(std::ceil(double(frames) * fraction));
+            std::uint64_t seen = 0;
+            for (std::size_t bucket = 0; bucket < kBuckets; ++bucket) {
+                seen += buckets[bucket];
+                if (seen >= rank)
+                    return double(BucketHigh(bucket)) / 1000.0;
+            }
+            return double(BucketHigh(kBuckets - 1)) / 1000.0;
+        };
+        summary.P50Ms = percentile(0.50);
+        summary.P99Ms = percentile(0.99);
+        summary.P999Ms = percentile(0.999);
+
+        // Walk down from the slowest bucket until 1% of the frames are covered, using bucket midpoints.
+        std::uint64_t wanted = std::max<std::uint64_t>(frames / 100, 1);
+        std::uint64_t taken = 0;
+        double micros = 0.0;
+        for (std::size_t bucket = kBuckets; bucket-- > 0 && taken < wanted; ) {
+            std::uint64_t count = std::min(buckets[bucket], wanted - taken);
+            micros += double(count) * (double(BucketLow(bucket)) + double(BucketHigh(bucket))) / 2.0;
+            taken += count;
+        }
+        if (micros > 0.0)
+            summary.OnePercentLowFps = 1e6 / (micros / double(taken));
+        return summary;
+    }
+
+    // Writes one CSV row per interval and logs hitches, from its own thread.
+    inline bool Start(const std::filesystem::path& path, std::chrono::seconds interval)
+    {
+        auto file = std::make_shared<std::ofstream>(path, std::ios::trunc);
+        if (!*file)
+            return false;
+        *file << "time_s,frames,avg_ms,p50_ms,p99_ms,p99.9_ms,1%_low_fps,hitches\n" << std::flush;
+
+        State& state = Get();
+        state.Enabled.store(true, std::memory_order_relaxed);
+
+        std::thread([file, interval] {
+            State& state = Get();
+            std::array<std::uint64_t, kBuckets> previous{};
+            std::uint64_t previousMicros = 0;
+            auto start = std::chrono::steady_clock::now();
+
+            for (;;) {
+                std::this_thread::sleep_for(interval);
+
+                std::array<std::uint64_t, kBuckets> buckets{};
+                std::array<std::uint64_t, kBuckets> current{};
+                for (std::size_t bucket = 0; bucket < kBuckets; ++bucket) {
+                    current[bucket] = state.Buckets[bucket].load(std::memory_order_relaxed);
+                    buckets[bucket] = current[bucket] - previous[bucket];
+                }
+                std::uint64_t micros = state.TotalMicros.load(std::memory_order_relaxed);
+
+                // The counters are read one at a time, so the bucket total can be a frame or two
+                // off the frame count, go with the buckets.
+                std::uint64_t intervalFrames = 0;
+                for (auto count : buckets)
+                    intervalFrames += count;
+                Summary summary = Summarise(buckets, intervalFrames, micros - previousMicros);
+                previous = current;
+                previousMicros = micros;
+
+                std::size_t hitches = 0;
+                std::size_t tail = state.HitchTail.load(std::memory_order_relaxed);
+                std::size_t head = state.HitchHead.load(std::memory_order_acquire);
+                std::size_t hooks = state.HookCount.load(std::memory_order_acquire);
+                std::string untracked;
+                for (std::size_t id = 0, count = state.UntrackedCount.load(std::memory_order_acquire); id < count; ++id)
+                    untracked += (untracked.empty() ? "" : ", ") + std::string(state.UntrackedNames[id]);
+                for (; tail != head; ++tail, ++hitches) {
+                    const Hitch& hitch = state.Hitches[tail % kMaxHitches];
+                    std::string fired;
+                    for (std::size_t id = 0; id < hooks; ++id) {
+                        if (hitch.Hooks & (std::uint64_t(1) << id))
+                            fired += (fired.empty() ? "" : ", ") + std::string(state.Names[id]);
+                    }
+                    spdlog::warn("Frame Telemetry: Hitch on frame {:d}: {:.2f}ms (median {:.2f}ms), hooks: {:s}{:s}{:s}", hitch.Frame, hitch.Micros / 1000.0, hitch.MedianMicros / 1000.0,
+                        fired.empty() ? "none" : fired, untracked.empty() ? "" : ", not tracked: ", untracked);
+                }
+                state.HitchTail.store(tail, std::memory_order_release);
+                if (std::uint64_t dropped = state.HitchesDropped.exchange(0, std::memory_order_relaxed)) {
+                    spdlog::warn("Frame Telemetry: {:d} more hitch(es) not shown.", dropped);
+                    hitches += dropped;
+                }
+
+                double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                *file << std::fixed;
+                file->precision(1);
+                *file << elapsed << ',' << summary.Frames << ',';
+                file->precision(3);
+                *file << summary.AverageMs << ',' << summary.P50Ms << ',' << summary.P99Ms << ',' << summary.P999Ms << ',';
+                file->precision(1);
+                *file << summary.OnePercentLowFps << ',' << hitches << '\n' << std::flush;
+            }
+        }).detach();
+        return true;
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include "topology.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+// Game threads by name, learned from the hooks that can tell them apart. The thread policy is
+// applied to each thread the first time a hook sees it. One registry per process.
+namespace ThreadRegistry
+{
+    class Registry
+    {
+    public:
+        // Set before the hooks go live, only read afterwards.
+        void SetPolicy(std::vector<Topology::Assignment> assignments)
+        {
+            policy = std::move(assignments);
+        }
+
+        // Called from a hook on the thread it names. Only the first call on each thread does any work.
+        void Learn(const char* name)
+        {
+            thread_local const char* known = nullptr;
+            if (known == name)
+                return;
+            known = name;
+            Register(name);
+        }
+
+    private:
+        std::vector<Topology::Assignment> policy;
+
+        void Register(const char* name)
+        {
+            DWORD id = GetCurrentThreadId();
+            for (const auto& assignment : policy) {
+                if (assignment.Thread != name)
+                    continue;
+
+                HANDLE thread = GetCurrentThread();
+                if (assignment.Mask && !SetThreadAffinityMask(thread, static_cast<DWORD_PTR>(assignment.Mask)))
+                    spdlog::error("Thread Policy: {:s}: Failed to set affinity (error {:d}).", name, GetLastError());
+                if (assignment.Priority && !SetThreadPriority(thread, *assignment.Priority))
+                    spdlog::error("Thread Policy: {:s}: Failed to set priority (error {:d}).", name, GetLastError());
+
+                char mask[24] = "unchanged";
+                if (assignment.Mask)
+                    std::snprintf(mask, sizeof(mask), "0x%llx", static_cast<unsigned long long>(assignment.Mask));
+                spdlog::info("Thread Policy: {:s} is thread {:d}, affinity {:s}, priority {:s} ({:s}).", name, id, mask,
+                    assignment.Priority ? std::to_string(*assignment.Priority) : "unchanged", assignment.Reason);
+                return;
+            }
+            spdlog::info("Thread Registry: {:s} is thread {:d}.", name, id);
+        }
+    };
+}
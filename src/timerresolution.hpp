@@ -0,0 +1,100 @@
+#pragma once
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// System timer resolution: raised once at startup, read back, and put back when the fix unloads.
+// Goes through ntdll since timeBeginPeriod only does whole milliseconds.
+namespace TimerResolution
+{
+    // Resolutions are in 100ns units, like ntdll's.
+    class Manager
+    {
+    public:
+        // Asks for resolution (e.g. 5000 = 0.5ms). Returns false if the API isn't there or refused it.
+        bool Request(ULONG resolution)
+        {
+            if (!Resolve())
+                return false;
+
+            ULONG current = 0;
+            NtQueryTimerResolution(&coarsest, &finest, &original);
+            if (NtSetTimerResolution(resolution, TRUE, &current) != 0)
+                return false;
+
+            // The kernel rounds to what the hardware supports, and another process may already hold a finer one.
+            NtQueryTimerResolution(&coarsest, &finest, &granted);
+            requested = true;
+            return true;
+        }
+
+        // Drops our request. Safe to call from DllMain, it's a single ntdll call.
+        void Restore()
+        {
+            if (!requested)
+                return;
+            ULONG current = 0;
+            NtSetTimerResolution(0, FALSE, &current);
+            requested = false;
+        }
+
+        ULONG Original() const { return original; }
+        ULONG Granted() const { return granted; }
+        ULONG Finest() const { return finest; }
+        ULONG Coarsest() const { return coarsest; }
+
+    private:
+        typedef NTSTATUS(NTAPI* _NtSetTimerResolution)(ULONG DesiredResolution, BOOLEAN SetResolution, PULONG CurrentResolution);
+        typedef NTSTATUS(NTAPI* _NtQueryTimerResolution)(PULONG MaximumResolution, PULONG MinimumResolution, PULONG CurrentResolution);
+
+        _NtSetTimerResolution NtSetTimerResolution = nullptr;
+        _NtQueryTimerResolution NtQueryTimerResolution = nullptr;
+        ULONG coarsest = 0;
+        ULONG finest = 0;
+        ULONG original = 0;
+        ULONG granted = 0;
+        bool requested = false;
+
+        bool Resolve()
+        {
+            if (NtSetTimerResolution && NtQueryTimerResolution)
+                return true;
+
+            HMODULE ntdll = GetModuleHandleA("ntdll.dll");
+            if (!ntdll)
+                return false;
+            NtSetTimerResolution = reinterpret_cast<_NtSetTimerResolution>(reinterpret_cast<void*>(GetProcAddress(ntdll, "NtSetTimerResolution")));
+            NtQueryTimerResolution = reinterpret_cast<_NtQueryTimerResolution>(reinterpret_cast<void*>(GetProcAddress(ntdll, "NtQueryTimerResolution")));
+            return NtSetTimerResolution && NtQueryTimerResolution;
+        }
+    };
+
+    // How late Sleep(1) wakes up, in microseconds past the millisecond asked for.
+    struct Jitter
+    {
+        double MeanUs;
+        double P99Us;
+        double MaxUs;
+    };
+
+    inline Jitter MeasureSleepJitter(int samples = 100)
+    {
+        std::vector<double> late;
+        late.reserve(samples);
+        for (int i = 0; i < samples; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            Sleep(1);
+            auto slept = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            late.push_back(std::max(slept - 1000.00, 0.00));
+        }
+        std::sort(late.begin(), late.end());
+
+        double total = 0.00;
+        for (double value : late)
+            total += value;
+        return { total / late.size(), late[std::min(late.size() - 1, late.size() * 99 / 100)], late.back() };
+    }
+}
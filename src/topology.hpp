@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+// CPU layout (core types, L3 cache domains) and the planner that turns per-thread rules into
+// affinity masks for it. Only Detect() touches the OS, so tools/topoplan.cpp runs the planner on
+// made-up machines.
+namespace Topology
+{
+    struct Processor
+    {
+        std::uint8_t Index;             // Logical processor, bit in the affinity mask
+        std::uint8_t Core;              // Physical core, shared by SMT siblings
+        std::uint8_t Efficiency;        // Higher is faster (P-cores above E-cores), all equal on non-hybrid CPUs
+        std::uint8_t Domain;            // L3 cache domain (CCD/CCX on AMD)
+    };
+
+    struct Machine
+    {
+        std::vector<Processor> Processors;
+        std::vector<std::uint32_t> DomainCacheKB;   // L3 size per domain
+
+        std::uint64_t All() const
+        {
+            std::uint64_t mask = 0;
+            for (const auto& processor : Processors)
+                mask |= std::uint64_t(1) << processor.Index;
+            return mask;
+        }
+    };
+
+    enum class Placement : std::uint8_t
+    {
+        Any,            // Leave affinity alone
+        Performance,    // Fastest cores of the best L3 domain, shared with other Performance threads
+        Efficiency,     // Slowest cores of the best L3 domain, or whatever isn't pinned on non-hybrid CPUs
+        Pin,            // A physical core of its own on the best L3 domain
+    };
+
+    struct Rule
+    {
+        std::string Thread;
+        Placement Place = Placement::Any;
+        std::optional<int> Priority;    // Win32 thread priority, unchanged if empty
+    };
+
+    struct Assignment
+    {
+        std::string Thread;
+        std::uint64_t Mask = 0;         // 0 = leave affinity alone
+        std::optional<int> Priority;
+        std::string Reason;
+    };
+
+    inline std::string_view Trim(std::string_view text)
+    {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+            text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
+            text.remove_suffix(1);
+        return text;
+    }
+
+    // Parses "Placement[, Priority]" from an ini value, e.g. "Pin, Highest".
+    inline std::optional<Rule> ParseRule(std::string_view thread, std::string_view value)
+    {
+        Rule rule;
+        rule.Thread = thread;
+        auto comma = value.find(',');
+        auto place = Trim(value.substr(0, comma));
+        if (place == "Any")
+            rule.Place = Placement::Any;
+        else if (place == "Performance")
+            rule.Place = Placement::Performance;
+        else if (place == "Efficiency")
+            rule.Place = Placement::Efficiency;
+        else if (place == "Pin")
+            rule.Place = Placement::Pin;
+        else
+            return std::nullopt;
+
+        if (comma == std::string_view::npos)
+            return rule;
+        auto priority = Trim(value.substr(comma + 1));
+        if (priority == "Lowest")
+            rule.Priority = -2;
+        else if (priority == "BelowNormal")
+            rule.Priority = -1;
+        else if (priority == "Normal")
+            rule.Priority = 0;
+        else if (priority == "AboveNormal")
+            rule.Priority = 1;
+        else if (priority == "Highest")
+            rule.Priority = 2;
+        else if (priority != "Unchanged")
+            return std::nullopt;
+        return rule;
+    }
+
+    // The domain with the fastest cores, then the most L3 (X3D's V-cache CCD), then the most fast cores.
+    inline std::uint8_t BestDomain(const Machine& machine)
+    {
+        std::uint8_t fastest = 0;
+        for (const auto& processor : machine.Processors)
+            fastest = std::max(fastest, processor.Efficiency);
+
+        std::uint8_t best = 0;
+        std::uint64_t bestScore = 0;
+        for (std::size_t domain = 0; domain < std::max<std::size_t>(machine.DomainCacheKB.size(), 1); ++domain) {
+            std::uint64_t fastCores = 0;
+            for (const auto& processor : machine.Processors) {
+                if (processor.Domain == domain && processor.Efficiency == fastest)
+                    fastCores++;
+            }
+            if (!fastCores)
+                continue;
+            std::uint64_t cache = domain < machine.DomainCacheKB.size() ? machine.DomainCacheKB[domain] : 0;
+            std::uint64_t score = (cache << 16) | fastCores;
+            if (score > bestScore) {
+                bestScore = score;
+                best = static_cast<std::uint8_t>(domain);
+            }
+        }
+        return best;
+    }
+
+    // Pinned threads are given cores first, so shared placements can avoid them.
+    inline std::vector<Assignment> Plan(const Machine& machine, const std::vector<Rule>& rules)
+    {
+        std::vector<Assignment> plan(rules.size());
+        if (machine.Processors.empty())
+            return plan;
+
+        std::uint8_t fastest = 0;
+        std::uint8_t slowest = 0xFF;
+        for (const auto& processor : machine.Processors) {
+            fastest = std::max(fastest, processor.Efficiency);
+            slowest = std::min(slowest, processor.Efficiency);
+        }
+        bool hybrid = fastest != slowest;
+        std::uint8_t domain = BestDomain(machine);
+
+        // Fast cores of the best domain, in core order, each with the mask of its SMT siblings.
+        std::vector<std::pair<std::uint8_t, std::uint64_t>> cores;
+        for (const auto& processor : machine.Processors) {
+            if (processor.Domain != domain || processor.Efficiency != fastest)
+                continue;
+            auto found = std::find_if(cores.begin(), cores.end(), [&](const auto& core) { return core.first == processor.Core; });
+            if (found == cores.end())
+                cores.emplace_back(processor.Core, std::uint64_t(1) << processor.Index);
+            else
+                found->second |= std::uint64_t(1) << processor.Index;
+        }
+        std::sort(cores.begin(), cores.end());
+        std::uint64_t fastMask = 0;
+        for (const auto& core : cores)
+            fastMask |= core.second;
+
+        // Core 0 takes most interrupts, so it's handed out last.
+        if (cores.size() > 1)
+            std::rotate(cores.begin(), cores.begin() + 1, cores.end());
+
+        std::uint64_t pinned = 0;
+        std::size_t nextCore = 0;
+        for (std::size_t i = 0; i < rules.size(); ++i) {
+            plan[i].Thread = rules[i].Thread;
+            plan[i].Priority = rules[i].Priority;
+            if (rules[i].Place != Placement::Pin)
+                continue;
+
+            // Always leave one fast core for everything else.
+            if (nextCore + 1 < cores.size()) {
+                plan[i].Mask = cores[nextCore++].second;
+                pinned |= plan[i].Mask;
+                plan[i].Reason = "own core on L3 domain " + std::to_string(domain);
+            }
+            else {
+                plan[i].Mask = fastMask;
+                plan[i].Reason = "no core left to pin, sharing the fast cores";
+            }
+        }
+
+        std::uint64_t all = machine.All();
+        for (std::size_t i = 0; i < rules.size(); ++i) {
+            switch (rules[i].Place) {
+            case Placement::Any:
+                plan[i].Reason = "affinity unchanged";
+                break;
+            case Placement::Performance:
+                plan[i].Mask = (fastMask & ~pinned) ? fastMask & ~pinned : fastMask;
+                plan[i].Reason = hybrid ? "fast cores on L3 domain " + std::to_string(domain) : "L3 domain " + std::to_string(domain);
+                break;
+            case Placement::Efficiency: {
+                // The slowest cores sharing the best L3, so the thread keeps the cache. Cores outside
+                // every L3 (low power E-cores) are only used when the domain has no slower cores.
+                std::uint8_t domainSlowest = fastest;
+                for (const auto& processor : machine.Processors) {
+                    if (processor.Domain == domain)
+                        domainSlowest = std::min(domainSlowest, processor.Efficiency);
+                }
+                bool inDomain = domainSlowest != fastest;
+
+                std::uint64_t slowMask = 0;
+                for (const auto& processor : machine.Processors) {
+                    bool slow = inDomain ? processor.Domain == domain && processor.Efficiency == domainSlowest : processor.Efficiency == slowest;
+                    if (hybrid ? slow : !(pinned & (std::uint64_t(1) << processor.Index)))
+                        slowMask |= std::uint64_t(1) << processor.Index;
+                }
+                plan[i].Mask = slowMask ? slowMask : all;
+                plan[i].Reason = !hybrid ? "cores not pinned" : inDomain ? "efficiency cores on L3 domain " + std::to_string(domain) : "efficiency cores";
+                break;
+            }
+            case Placement::Pin:
+                break;
+            }
+
+            // A mask of every processor changes nothing.
+            if (plan[i].Mask == all)
+                plan[i].Mask = 0;
+        }
+        return plan;
+    }
+
+#if defined(_WIN32)
+    // The machine as Windows reports it. Only processor group 0 is covered, which is every CPU with up
+    // to 64 logical processors.
+    inline Machine Detect()
+    {
+        Machine machine;
+        DWORD size = 0;
+        GetLogicalProcessorInformationEx(RelationAll, nullptr, &size);
+        std::vector<std::uint8_t> buffer(size);
+        if (!size || !GetLogicalProcessorInformationEx(RelationAll, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &size))
+            return machine;
+
+        std::vector<std::pair<KAFFINITY, std::uint32_t>> caches;
+        std::uint8_t core = 0;
+        for (DWORD offset = 0; offset < size; ) {
+            auto* info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+            if (info->Relationship == RelationProcessorCore && info->Processor.GroupMask[0].Group == 0) {
+                KAFFINITY mask = info->Processor.GroupMask[0].Mask;
+                for (std::uint8_t index = 0; index < 64; ++index) {
+                    if (mask & (KAFFINITY(1) << index))
+                        machine.Processors.push_back({ index, core, info->Processor.EfficiencyClass, 0 });
+                }
+                core++;
+            }
+            else if (info->Relationship == RelationCache && info->Cache.Level == 3 && info->Cache.GroupMask.Group == 0) {
+                caches.emplace_back(info->Cache.GroupMask.Mask, info->Cache.CacheSize / 1024);
+            }
+            offset += info->Size;
+        }
+
+        // Processors outside every L3 (e.g. low power E-cores) don't belong to any domain.
+        if (!caches.empty()) {
+            for (auto& processor : machine.Processors)
+                processor.Domain = 0xFF;
+        }
+        for (std::size_t domain = 0; domain < caches.size(); ++domain) {
+            machine.DomainCacheKB.push_back(caches[domain].second);
+            for (auto& processor : machine.Processors) {
+                if (caches[domain].first & (KAFFINITY(1) << processor.Index))
+                    processor.Domain = static_cast<std::uint8_t>(domain);
+            }
+        }
+        return machine;
+    }
+#endif
+}
@@ -0,0 +1,199 @@
+// Replays a hook capture (MGSVFix_hooks.bin, see [Hook Capture] in the ini) through the same callback
+// code the fix runs in game. Checks every output register and touched byte against the recording,
+// then times each callback.
+//
+//   hookreplay [--iterations N] <capture.bin>
+//
+// Exits 0 if every record replays identically, 1 on any mismatch, 2 on usage or I/O errors.
+// HUD background rules added in the ini aren't part of the capture, only the built-in ones are used.
+
+#include "callbacks.hpp"
+#include "hookcapture.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // A record with its memory spans backed by local buffers, ready to run.
+    struct Prepared
+    {
+        const HookCapture::Record* Source;
+        SafetyHookContext Before;
+        SafetyHookContext Expected;
+        std::vector<std::vector<std::uint8_t>> Buffers;    // One per register the spans use
+        std::vector<std::uint8_t*> SpanAddresses;
+    };
+
+    Prepared Prepare(const HookCapture::Record& record)
+    {
+        Prepared prepared{ &record, record.Before, record.After, {}, {} };
+
+        std::vector<std::uint16_t> registers;
+        for (const auto& span : record.Spans) {
+            if (std::find(registers.begin(), registers.end(), span.Where.Register) == registers.end())
+                registers.push_back(span.Where.Register);
+        }
+        for (std::uint16_t reg : registers) {
+            std::size_t size = 0;
+            for (const auto& span : record.Spans) {
+                if (span.Where.Register == reg)
+                    size = std::max<std::size_t>(size, span.Where.Offset + span.Where.Size);
+            }
+            auto& buffer = prepared.Buffers.emplace_back(size);
+
+            // Point the register at the local copy, in the expected output too if the callback left it alone.
+            auto base = reinterpret_cast<std::uintptr_t>(buffer.data());
+            if (HookCapture::Register(prepared.Expected, reg) == HookCapture::Register(prepared.Before, reg))
+                HookCapture::Register(prepared.Expected, reg) = base;
+            HookCapture::Register(prepared.Before, reg) = base;
+        }
+        for (const auto& span : record.Spans) {
+            auto index = std::find(registers.begin(), registers.end(), span.Where.Register) - registers.begin();
+            prepared.SpanAddresses.push_back(prepared.Buffers[index].data() + span.Where.Offset);
+        }
+        return prepared;
+    }
+
+    void ApplyState(const HookCapture::Record& record, int& resX, int& resY)
+    {
+        if (record.Header.ResX != resX || record.Header.ResY != resY) {
+            resX = record.Header.ResX;
+            resY = record.Header.ResY;
+            Callbacks::renderScale.Store(RenderScale::Compute(resX, resY));
+        }
+        Callbacks::bIsMoviePlaying.store(record.Header.Flags & HookCapture::MovieBefore, std::memory_order_relaxed);
+    }
+
+    void ResetMemory(Prepared& prepared)
+    {
+        for (std::size_t i = 0; i < prepared.SpanAddresses.size(); ++i)
+            std::memcpy(prepared.SpanAddresses[i], prepared.Source->Spans[i].Before.data(), prepared.Source->Spans[i].Before.size());
+    }
+
+    bool Check(const Prepared& prepared, const SafetyHookContext& ctx)
+    {
+        if (std::memcmp(&ctx, &prepared.Expected, sizeof(ctx)) != 0)
+            return false;
+        for (std::size_t i = 0; i < prepared.SpanAddresses.size(); ++i) {
+            const auto& after = prepared.Source->Spans[i].After;
+            if (std::memcmp(prepared.SpanAddresses[i], after.data(), after.size()) != 0)
+                return false;
+        }
+        bool movie = Callbacks::bIsMoviePlaying.load(std::memory_order_relaxed);
+        return movie == bool(prepared.Source->Header.Flags & HookCapture::MovieAfter);
+    }
+
+    // Hooks call their destination through a pointer, so the timing loops do too.
+    template <std::size_t... Ids>
+    constexpr auto MakeRunTable(std::index_sequence<Ids...>)
+    {
+        return std::array<void (*)(SafetyHookContext&), sizeof...(Ids)>{ [](SafetyHookContext& ctx) { Callbacks::Run(static_cast<Callbacks::Id>(Ids), ctx); }... };
+    }
+
+    constexpr auto kRun = MakeRunTable(std::make_index_sequence<static_cast<std::size_t>(Callbacks::Id::Count)>());
+
+    void Nothing(SafetyHookContext&) {}
+
+    int Usage()
+    {
+        std::fprintf(stderr, "Usage: hookreplay [--iterations N] <capture.bin>\n");
+        return 2;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 1000;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc)
+            iterations = std::max(std::atoi(argv[++i]), 1);
+        else if (arg.starts_with("--") || path)
+            return Usage();
+        else
+            path = argv[i];
+    }
+    if (!path)
+        return Usage();
+
+    auto capture = HookCapture::Load(path);
+    if (!capture) {
+        std::fprintf(stderr, "%s: Not a hook capture.\n", path);
+        return 2;
+    }
+    const auto& [header, records] = *capture;
+
+    // Rebuild the state the fix had when it recorded.
+    auto game = static_cast<Game>(header.Game);
+    Callbacks::lodSettings.Store({ header.TerrainDistance, header.ModelDistance, header.GrassDistance });
+    Callbacks::HUDBackgroundsLayout = { header.HUDWidthOffset, header.HUDHeightOffset, header.HUDScaleOffset };
+    Callbacks::HUDBackgroundsTable.Build(std::vector<HUDRules::Rule>(std::begin(HUDRules::kDefaultRules), std::end(HUDRules::kDefaultRules)), game);
+
+    std::vector<Prepared> prepared;
+    prepared.reserve(records.size());
+    for (const auto& record : records)
+        prepared.push_back(Prepare(record));
+
+    std::printf("%s: %zu records (%s)\n", path, records.size(), game == Game::GZ ? "GZ" : game == Game::TPP ? "TPP" : "unknown game");
+    std::printf("  %-20s %8s %10s %10s\n", "Hook", "Records", "Mismatch", "ns/call");
+
+    int resX = 0, resY = 0;
+    std::size_t totalMismatches = 0;
+    for (std::size_t hook = 0; hook < static_cast<std::size_t>(Callbacks::Id::Count); ++hook) {
+        auto id = static_cast<Callbacks::Id>(hook);
+        std::vector<Prepared*> mine;
+        for (auto& entry : prepared) {
+            if (entry.Source->Header.Hook == hook)
+                mine.push_back(&entry);
+        }
+        if (mine.empty())
+            continue;
+
+        // Correctness: each record once, in capture order.
+        std::size_t mismatches = 0;
+        for (auto* entry : mine) {
+            ApplyState(*entry->Source, resX, resY);
+            ResetMemory(*entry);
+            SafetyHookContext ctx = entry->Before;
+            Callbacks::Run(id, ctx);
+            if (!Check(*entry, ctx))
+                mismatches++;
+        }
+        totalMismatches += mismatches;
+
+        // Timing: the same loop with and without the callback, the difference is the callback.
+        auto timeLoop = [&](void (*run)(SafetyHookContext&)) {
+            void (*volatile destination)(SafetyHookContext&) = run;
+            auto start = Clock::now();
+            for (int iteration = 0; iteration < iterations; ++iteration) {
+                for (auto* entry : mine) {
+                    ApplyState(*entry->Source, resX, resY);
+                    ResetMemory(*entry);
+                    SafetyHookContext ctx = entry->Before;
+                    destination(ctx);
+                }
+            }
+            return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        };
+        double baseline = timeLoop(Nothing);
+        double total = timeLoop(kRun[hook]);
+        double perCall = std::max(total - baseline, 0.0) / (double(iterations) * double(mine.size()));
+
+        std::printf("  %-20s %8zu %10zu %10.2f\n", Callbacks::kNames[hook], mine.size(), mismatches, perCall);
+    }
+
+    std::printf("  %zu/%zu records replayed identically.\n", records.size() - totalMismatches, records.size());
+    return totalMismatches ? 1 : 0;
+}
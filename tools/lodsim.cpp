@@ -0,0 +1,144 @@
+// Runs the LOD governor against a frame time trace, to tune its settings without the game.
+//
+//   lodsim [--target MS] [--hysteresis PCT] [--window N] [--raise-after N] <trace.txt>
+//   lodsim [options] --synthetic
+//
+// A trace is one frame time in milliseconds per line. Traces are replayed as recorded, so they show
+// when the governor would react but not how the game would respond. --synthetic instead simulates a
+// light scene, a heavy one (e.g. a base assault) and a light one again, where the heavy scene's cost
+// grows with the distances the governor picks.
+// Exits 0 when done, 2 on usage or I/O errors.
+
+#include "lodgovernor.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    struct Scene
+    {
+        const char* Name;
+        int Frames;
+        float BaseMs;       // Cost at minimum distances
+        float LODMs;        // Extra cost at maximum distances
+    };
+
+    constexpr Scene kScenes[] = {
+        { "light",  1800, 9.00f,  3.00f },
+        { "heavy",  3600, 12.00f, 9.00f },
+        { "light",  1800, 9.00f,  3.00f },
+    };
+
+    struct Summary
+    {
+        int Frames = 0;
+        int OverTarget = 0;
+        int Decisions = 0;
+        double TotalMs = 0.00;
+    };
+
+    void Report(int frame, const LODGovernor::Decision& decision)
+    {
+        std::printf("  frame %6d: %-5s level %.2f, window %.2fms, model %.0f, grass %.0f\n", frame, decision.Raised ? "raise" : "lower",
+                    decision.Level, decision.WindowMs, decision.ModelDistance, decision.GrassDistance);
+    }
+
+    void Count(Summary& summary, float frameMs, float targetMs)
+    {
+        summary.Frames++;
+        summary.TotalMs += frameMs;
+        if (frameMs > targetMs)
+            summary.OverTarget++;
+    }
+
+    int Usage()
+    {
+        std::fprintf(stderr, "Usage: lodsim [--target MS] [--hysteresis PCT] [--window N] [--raise-after N] <trace.txt | --synthetic>\n");
+        return 2;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    LODGovernor::Settings settings;
+    bool synthetic = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--synthetic")
+            synthetic = true;
+        else if (arg == "--target" && i + 1 < argc)
+            settings.TargetMs = std::max(static_cast<float>(std::atof(argv[++i])), 1.00f);
+        else if (arg == "--hysteresis" && i + 1 < argc)
+            settings.Hysteresis = std::clamp(static_cast<float>(std::atof(argv[++i])), 0.00f, 50.00f) / 100.00f;
+        else if (arg == "--window" && i + 1 < argc)
+            settings.WindowFrames = std::atoi(argv[++i]);
+        else if (arg == "--raise-after" && i + 1 < argc)
+            settings.RaiseAfter = std::atoi(argv[++i]);
+        else if (arg.starts_with("--") || path)
+            return Usage();
+        else
+            path = argv[i];
+    }
+    if (synthetic == (path != nullptr))
+        return Usage();
+
+    LODGovernor::Controller governor(settings);
+    Summary summary;
+    std::printf("Target %.2fms, %.0f%% dead band, %d frame window, raise after %d window(s).\n", settings.TargetMs, settings.Hysteresis * 100.00f, settings.WindowFrames, settings.RaiseAfter);
+
+    if (synthetic) {
+        std::mt19937 random(1);
+        std::normal_distribution<float> noise(0.00f, 0.60f);
+        int frame = 0;
+        for (const auto& scene : kScenes) {
+            Summary sceneSummary;
+            std::printf("%s scene, %d frames:\n", scene.Name, scene.Frames);
+            for (int i = 0; i < scene.Frames; ++i, ++frame) {
+                float frameMs = std::max(scene.BaseMs + scene.LODMs * governor.Level() + noise(random), 1.00f);
+                Count(summary, frameMs, settings.TargetMs);
+                Count(sceneSummary, frameMs, settings.TargetMs);
+                if (auto decision = governor.Add(frameMs)) {
+                    summary.Decisions++;
+                    Report(frame, *decision);
+                }
+            }
+            std::printf("  avg %.2fms, %.1f%% of frames over target, ended at level %.2f\n", sceneSummary.TotalMs / sceneSummary.Frames,
+                        100.00 * sceneSummary.OverTarget / sceneSummary.Frames, governor.Level());
+        }
+    }
+    else {
+        std::ifstream trace(path);
+        if (!trace) {
+            std::fprintf(stderr, "%s: Can't open file.\n", path);
+            return 2;
+        }
+        std::string line;
+        while (std::getline(trace, line)) {
+            char* end = nullptr;
+            float frameMs = std::strtof(line.c_str(), &end);
+            if (end == line.c_str() || frameMs <= 0.00f)
+                continue;
+            Count(summary, frameMs, settings.TargetMs);
+            if (auto decision = governor.Add(frameMs)) {
+                summary.Decisions++;
+                Report(summary.Frames - 1, *decision);
+            }
+        }
+    }
+
+    if (!summary.Frames) {
+        std::fprintf(stderr, "%s: No frame times.\n", path);
+        return 2;
+    }
+    std::printf("%d frames, avg %.2fms, %.1f%% over target, %d decision(s), final level %.2f (model %.0f, grass %.0f).\n", summary.Frames,
+                summary.TotalMs / summary.Frames, 100.00 * summary.OverTarget / summary.Frames, summary.Decisions, governor.Level(),
+                governor.ModelDistance(), governor.GrassDistance());
+    return 0;
+}
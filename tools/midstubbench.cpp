@@ -0,0 +1,220 @@
+// Times lean mid hook stubs against the full context stub, and checks they preserve the registers
+// the hooked code relies on.
+//
+//   midstubbench [calls]
+//
+// The stubs are the Win64 ones the game gets, with the destination built for the Windows calling
+// convention, so they behave here as they would behind a hook. The full context stub is the same
+// generator with every register declared, which does the same saves as safetyhook's prebuilt stub.
+// Instead of an inline hook's trampoline, each stub returns through a lone ret, straight back to
+// the caller.
+// Exits 0 if every check passes, 1 if any fails, 2 on usage or setup errors (POSIX, x86-64 only).
+
+#include <safetyhook.hpp>
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    using Stub = void(__attribute__((ms_abi))*)();
+
+    volatile float aspectMultiplier = 1.33f;
+
+    // The Overlay and ThreadSleep callbacks' work, plus clobbering registers the ABI lets it.
+    __attribute__((ms_abi, noinline)) void Destination(safetyhook::Context64& ctx)
+    {
+        ctx.xmm5.f32[0] *= aspectMultiplier;
+        if (ctx.rbp == 0x01)
+            ctx.rdx = 0;
+        asm volatile("xorps %%xmm4, %%xmm4\n\txor %%r10d, %%r10d" ::: "xmm4", "r10");
+    }
+
+    __attribute__((ms_abi, noinline)) void Empty(safetyhook::Context64&) {}
+
+    struct Built
+    {
+        const char* Name;
+        safetyhook::MidRegisters Registers;
+        std::size_t Size;
+        Stub Call;
+    };
+
+    // Copies stubs into executable memory, each followed by its destination and a ret to use as the trampoline.
+    class Code
+    {
+    public:
+        bool Open()
+        {
+            memory = static_cast<std::uint8_t*>(mmap(nullptr, kSize, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+            return memory != MAP_FAILED;
+        }
+
+        Stub Add(std::vector<std::uint8_t> stub, void (__attribute__((ms_abi)) *destination)(safetyhook::Context64&))
+        {
+            used = (used + 15) & ~std::size_t(15);
+            std::uint8_t* start = memory + used;
+            std::uint8_t* ret = start + stub.size();
+            *ret = 0xC3;
+            safetyhook::store(stub.data() + stub.size() - 16, reinterpret_cast<void*>(destination));
+            safetyhook::store(stub.data() + stub.size() - 8, ret);
+            std::memcpy(start, stub.data(), stub.size());
+            used += stub.size() + 1;
+            return reinterpret_cast<Stub>(start);
+        }
+
+    private:
+        static constexpr std::size_t kSize = 1 << 16;
+        std::uint8_t* memory = nullptr;
+        std::size_t used = 0;
+    };
+
+    struct Probe
+    {
+        float Xmm5;
+        float Xmm4;
+        float Xmm6;
+        std::uint32_t Pad;
+        std::uint64_t Rdx;
+        std::uint64_t Rbp;
+        std::uint64_t R10;
+        std::uint64_t R12;
+        std::uint8_t Carry;
+    };
+
+    // Calls the stub from hand-written code with known values in registers and records what comes back.
+    Probe Run(Stub stub, std::uint64_t rbp)
+    {
+        Probe probe{ 2.00f, 3.00f, 4.00f, 0, 0x55, rbp, 0, 0, 0 };
+        asm volatile(
+            "sub $128, %%rsp\n\t"                 // Stay clear of the red zone
+            "push %%rbp\n\t"
+            "movss 0(%%rdi), %%xmm5\n\t"
+            "movss 4(%%rdi), %%xmm4\n\t"
+            "movss 8(%%rdi), %%xmm6\n\t"
+            "mov 16(%%rdi), %%rdx\n\t"
+            "mov 24(%%rdi), %%rbp\n\t"
+            "movabs $0x1010101010101010, %%r10\n\t"
+            "movabs $0x1212121212121212, %%r12\n\t"
+            "stc\n\t"
+            "call *%%rsi\n\t"
+            "setc 48(%%rdi)\n\t"
+            "movss %%xmm5, 0(%%rdi)\n\t"
+            "movss %%xmm4, 4(%%rdi)\n\t"
+            "movss %%xmm6, 8(%%rdi)\n\t"
+            "mov %%rdx, 16(%%rdi)\n\t"
+            "mov %%rbp, 24(%%rdi)\n\t"
+            "mov %%r10, 32(%%rdi)\n\t"
+            "mov %%r12, 40(%%rdi)\n\t"
+            "pop %%rbp\n\t"
+            "add $128, %%rsp"
+            :
+            : "D"(&probe), "S"(stub)
+            : "rax", "rcx", "rdx", "r8", "r9", "r10", "r11", "r12", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5",
+              "xmm6", "xmm7", "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15", "memory", "cc");
+        return probe;
+    }
+
+    int Check(const Built& built)
+    {
+        int failures = 0;
+        auto expect = [&](bool ok, const char* what) {
+            if (!ok) {
+                std::printf("  FAIL %s: %s\n", built.Name, what);
+                failures++;
+            }
+        };
+
+        for (std::uint64_t rbp : { 0x01, 0x02 }) {
+            Probe probe = Run(built.Call, rbp);
+            expect(probe.Xmm5 == 2.00f * aspectMultiplier, "write to xmm5 lost");
+            expect(probe.Rdx == (rbp == 0x01 ? 0 : 0x55), "rdx wrong, rbp not seen or write lost");
+            expect(probe.Rbp == rbp, "rbp changed");
+            expect(probe.Xmm4 == 3.00f, "xmm4 clobbered by the destination");
+            expect(probe.R10 == 0x1010101010101010, "r10 clobbered by the destination");
+            expect(probe.Xmm6 == 4.00f, "xmm6 changed");
+            expect(probe.R12 == 0x1212121212121212, "r12 changed");
+            expect(probe.Carry == 1, "rflags changed");
+        }
+        return failures;
+    }
+
+    // Nanoseconds per call for each stub, best of several rounds. Rounds go through every stub in
+    // turn, so frequency changes and noisy neighbours hit them all alike.
+    std::vector<double> Time(const std::vector<Stub>& stubs, int calls)
+    {
+        std::vector<double> best(stubs.size(), 1e9);
+        for (int round = 0; round < 10; ++round) {
+            for (std::size_t i = 0; i < stubs.size(); ++i) {
+                auto start = std::chrono::steady_clock::now();
+                for (int call = 0; call < calls; ++call)
+                    stubs[i]();
+                best[i] = std::min(best[i], std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls);
+            }
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int calls = argc > 1 ? std::atoi(argv[1]) : 2'000'000;
+    if (argc > 2 || calls <= 0) {
+        std::fprintf(stderr, "Usage: midstubbench [calls]\n");
+        return 2;
+    }
+
+    Code code;
+    if (!code.Open()) {
+        std::fprintf(stderr, "Can't map executable memory.\n");
+        return 2;
+    }
+
+    using safetyhook::MidStubAbi;
+    namespace reg = safetyhook::reg;
+    const std::pair<const char*, safetyhook::MidRegisters> kStubs[] = {
+        { "full",       reg::all },
+        { "xmm5",       reg::xmm5 },                // Overlay
+        { "xmm0",       reg::xmm0 },                // MarkerConstraint
+        { "rbp+rdx",    reg::rbp | reg::rdx },      // ThreadSleep
+        { "check",      reg::xmm5 | reg::rbp | reg::rdx },
+    };
+
+    int failures = 0;
+    std::vector<Built> timed;
+    std::vector<Built> empty;
+    for (const auto& [name, registers] : kStubs) {
+        auto stub = safetyhook::make_lean_mid_stub(registers, MidStubAbi::Win64);
+        Built built{ name, registers, stub.size(), code.Add(stub, Destination) };
+        if (registers == reg::all || registers == (reg::xmm5 | reg::rbp | reg::rdx))
+            failures += Check(built);
+        if (registers != (reg::xmm5 | reg::rbp | reg::rdx)) {
+            timed.push_back(built);
+            empty.push_back({ name, registers, stub.size(), code.Add(stub, Empty) });
+        }
+    }
+
+    std::vector<Stub> stubs;
+    for (const auto& built : timed)
+        stubs.push_back(built.Call);
+    for (const auto& built : empty)
+        stubs.push_back(built.Call);
+    auto ns = Time(stubs, calls);
+
+    std::printf("%d calls per round, best of 10 rounds:\n", calls);
+    for (std::size_t i = 0; i < timed.size(); ++i) {
+        std::size_t e = timed.size() + i;
+        std::printf("  %-8s %3zu bytes  %6.2fns (%.2fx)  empty destination %6.2fns (%.2fx)\n", timed[i].Name, timed[i].Size, ns[i], ns[0] / ns[i],
+                    ns[e], ns[timed.size()] / ns[e]);
+    }
+
+    std::printf("%s\n", failures ? "Some stubs failed their checks." : "All stubs passed.");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,96 @@
+// Runs the frame limiter's pacer headless and measures how late it wakes, to check pacing changes
+// without the game.
+//
+//   pacesim [--seconds S] [--load PCT] [fps...]
+//
+// Each target runs for S seconds (default 2). Every frame busy-waits for a random share of the
+// period around --load percent (default 50) to stand in for the game's work, then waits on the
+// pacer. Lateness is how long after the frame's deadline the pacer returned, achieved is the mean
+// frame rate over the run. Without targets 30, 60, 120, 144 and 240fps are run.
+// Exits 0 when done, 2 on usage errors.
+
+#include "framelimiter.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    using FrameLimiter::Clock;
+
+    double Microseconds(Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+    void Run(double fps, double seconds, double load)
+    {
+        FrameLimiter::Pacer pacer;
+        pacer.SetTarget(fps);
+
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<double> share(std::max(0.00, load - 0.20), std::min(0.95, load + 0.20));
+        int frames = std::max(static_cast<int>(fps * seconds), 2);
+
+        std::vector<double> late;
+        late.reserve(frames);
+        pacer.Wait();
+        auto start = Clock::now();
+        for (int frame = 0; frame < frames; ++frame) {
+            auto work = std::chrono::duration_cast<Clock::duration>(pacer.Period() * share(random));
+            auto until = Clock::now() + work;
+            while (Clock::now() < until) {}
+            late.push_back(Microseconds(pacer.Wait()));
+        }
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        double mean = 0.00;
+        for (double value : late)
+            mean += value;
+        mean /= late.size();
+        std::sort(late.begin(), late.end());
+        double p99 = late[std::min(late.size() - 1, late.size() * 99 / 100)];
+
+        std::printf("  %6.1ffps  %5d frames  achieved %7.2ffps  late mean %7.1fus  p99 %7.1fus  max %8.1fus\n", fps, frames, frames / elapsed,
+                    mean, p99, late.back());
+    }
+
+    int Usage()
+    {
+        std::fprintf(stderr, "Usage: pacesim [--seconds S] [--load PCT] [fps...]\n");
+        return 2;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    double seconds = 2.00;
+    double load = 0.50;
+    std::vector<double> targets;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--seconds" && i + 1 < argc)
+            seconds = std::atof(argv[++i]);
+        else if (arg == "--load" && i + 1 < argc)
+            load = std::atof(argv[++i]) / 100.00;
+        else if (double fps = std::atof(argv[i]); fps > 0.00)
+            targets.push_back(fps);
+        else
+            return Usage();
+    }
+    if (seconds <= 0.00 || load < 0.00 || load > 0.95)
+        return Usage();
+    if (targets.empty())
+        targets = { 30.00, 60.00, 120.00, 144.00, 240.00 };
+
+    FrameLimiter::Pacer probe;
+    std::printf("Pacer with a %s timer, %.0f%% load, %.1fs per target:\n", probe.PreciseTimer() ? "precise" : "coarse", load * 100.00, seconds);
+    for (double fps : targets)
+        Run(fps, seconds, load);
+    return 0;
+}
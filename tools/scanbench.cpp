@@ -0,0 +1,187 @@
+// Times the signature scanners on a synthetic image: the original byte-by-byte loop against the
+// masked-compare scanner on each instruction set the CPU has, then the parallel scans at 1-8 threads,
+// and checks they all find the same matches.
+//
+//   scanbench [MiB]
+//
+// The image (128 MiB unless given) is random bytes weighted towards common x64 opcodes, with every
+// signature planted once in its last MiB, so each first-match scan has to cover nearly the whole image.
+// Exits 0 if every scanner agrees with the original loop, 1 if any doesn't, 2 on usage errors.
+
+#include "scanner.hpp"
+#include "signatures.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using Matches = std::vector<std::vector<const std::uint8_t*>>;
+
+    // Same walk as the original Memory::PatternScan/PatternScanAll: -1 is a wildcard.
+    std::vector<const std::uint8_t*> OriginalScan(const std::uint8_t* data, std::size_t size, const std::vector<int>& pattern, bool all)
+    {
+        std::vector<const std::uint8_t*> results;
+        auto s = pattern.size();
+        auto d = pattern.data();
+        for (std::size_t i = 0; i < size - s; ++i) {
+            bool found = true;
+            for (std::size_t j = 0; j < s; ++j) {
+                if (data[i + j] != d[j] && d[j] != -1) {
+                    found = false;
+                    break;
+                }
+            }
+            if (found) {
+                results.push_back(&data[i]);
+                if (!all)
+                    break;
+            }
+        }
+        return results;
+    }
+
+    std::vector<int> OriginalPattern(const Scanner::Pattern& pattern)
+    {
+        std::vector<int> bytes;
+        for (std::size_t i = 0; i < pattern.Size; ++i)
+            bytes.push_back(pattern.Mask[i] ? pattern.Bytes[i] : -1);
+        return bytes;
+    }
+
+    std::vector<std::uint8_t> MakeImage(std::size_t size)
+    {
+        constexpr std::uint8_t kCommon[] = { 0x00, 0xFF, 0x48, 0xCC, 0x8B, 0x89, 0x0F, 0x24, 0x4C, 0x44, 0x8D, 0x41, 0x83, 0x85, 0xC0, 0xE8 };
+        std::vector<std::uint8_t> image(size);
+        std::uint64_t state = 0x9E3779B97F4A7C15ull;
+        for (auto& byte : image) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            byte = (state >> 40) & 1 ? kCommon[(state >> 48) % sizeof(kCommon)] : static_cast<std::uint8_t>(state >> 56);
+        }
+
+        std::size_t at = size - (1 << 20);
+        for (const auto* signature : Signatures::kAll) {
+            const auto& pattern = signature->Pattern;
+            for (std::size_t i = 0; i < pattern.Size; ++i) {
+                if (pattern.Mask[i])
+                    image[at + i] = pattern.Bytes[i];
+            }
+            at += pattern.Size + 64;
+        }
+        return image;
+    }
+
+    // Seconds for the fastest of a few passes over every signature.
+    template <typename Fn>
+    double Time(Fn&& pass)
+    {
+        double best = 1e9;
+        for (int round = 0; round < 3; ++round) {
+            auto start = std::chrono::steady_clock::now();
+            pass();
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int mib = argc > 1 ? std::atoi(argv[1]) : 128;
+    if (argc > 2 || mib < 2) {
+        std::fprintf(stderr, "Usage: scanbench [MiB]\n");
+        return 2;
+    }
+
+    auto image = MakeImage(static_cast<std::size_t>(mib) << 20);
+    const std::uint8_t* data = image.data();
+    const std::size_t size = image.size();
+    const double scanned = static_cast<double>(size) * std::size(Signatures::kAll) / 1e9;
+    std::printf("%d MiB image, %zu signatures, best of 3 passes:\n", mib, std::size(Signatures::kAll));
+
+    Matches expected(std::size(Signatures::kAll));
+    double seconds = Time([&] {
+        for (std::size_t i = 0; i < std::size(Signatures::kAll); ++i)
+            expected[i] = OriginalScan(data, size, OriginalPattern(Signatures::kAll[i]->Pattern), Signatures::kAll[i]->All);
+    });
+    std::printf("  %-10s %8.1fms  %6.2f GB/s\n", "original", seconds * 1e3, scanned / seconds);
+
+    int failures = 0;
+    for (auto isa : { Scanner::Isa::Scalar, Scanner::Isa::SSE2, Scanner::Isa::AVX2 }) {
+        if (isa > Scanner::DetectIsa())
+            continue;
+
+        Matches found(std::size(Signatures::kAll));
+        seconds = Time([&] {
+            for (std::size_t i = 0; i < std::size(Signatures::kAll); ++i) {
+                const auto& pattern = Signatures::kAll[i]->Pattern;
+                if (Signatures::kAll[i]->All)
+                    found[i] = Scanner::FindAll(data, size, pattern, isa);
+                else if (auto match = Scanner::FindFirst(data, size, pattern, isa))
+                    found[i] = { match };
+                else
+                    found[i].clear();
+            }
+        });
+        std::printf("  %-10s %8.1fms  %6.2f GB/s\n", Scanner::IsaName(isa), seconds * 1e3, scanned / seconds);
+
+        for (std::size_t i = 0; i < found.size(); ++i) {
+            if (found[i] != expected[i]) {
+                std::printf("  FAIL %s: %s found %zu match(es), the original loop %zu\n", Signatures::kAll[i]->Name, Scanner::IsaName(isa), found[i].size(), expected[i].size());
+                failures++;
+            }
+        }
+    }
+
+    // Thread sweep. Scaling only means something with at least as many cores as threads.
+    std::vector<Scanner::Region> regions{ { data, size } };
+    std::vector<std::pair<Scanner::Pattern, Scanner::Mode>> batch;
+    for (const auto* signature : Signatures::kAll)
+        batch.push_back({ signature->Pattern, signature->All ? Scanner::Mode::All : Scanner::Mode::First });
+    auto multi = Scanner::BuildMultiPattern(batch);
+
+    std::printf("Parallel scans, %u hardware thread(s):\n", std::thread::hardware_concurrency());
+    double single = 0;
+    double batchSingle = 0;
+    for (unsigned threads : { 1u, 2u, 4u, 8u }) {
+        Matches found(std::size(Signatures::kAll));
+        seconds = Time([&] {
+            for (std::size_t i = 0; i < std::size(Signatures::kAll); ++i) {
+                const auto& pattern = Signatures::kAll[i]->Pattern;
+                if (Signatures::kAll[i]->All)
+                    found[i] = Scanner::FindAllParallel(regions, pattern, threads);
+                else if (auto match = Scanner::FindFirstParallel(regions, pattern, threads))
+                    found[i] = { match };
+                else
+                    found[i].clear();
+            }
+        });
+        Scanner::MultiResults batched;
+        double batchSeconds = Time([&] { batched = Scanner::ScanMultiParallel(multi, regions, threads); });
+        if (threads == 1) {
+            single = seconds;
+            batchSingle = batchSeconds;
+        }
+        std::printf("  %u thread(s)  one by one %8.1fms %6.2f GB/s (%.2fx)  batched %8.1fms (%.2fx)\n", threads, seconds * 1e3, scanned / seconds,
+                    single / seconds, batchSeconds * 1e3, batchSingle / batchSeconds);
+
+        for (std::size_t i = 0; i < found.size(); ++i) {
+            if (found[i] != expected[i] || batched[i] != expected[i]) {
+                std::printf("  FAIL %s: %u thread(s) found %zu match(es) one by one and %zu batched, the original loop %zu\n", Signatures::kAll[i]->Name,
+                            threads, found[i].size(), batched[i].size(), expected[i].size());
+                failures++;
+            }
+        }
+    }
+
+    std::printf("%s\n", failures ? "Some scanners disagree with the original loop." : "All scanners agree.");
+    return failures ? 1 : 0;
+}
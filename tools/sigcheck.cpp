@@ -0,0 +1,311 @@
+// Offline signature check: maps a game exe from disk the way the loader would and runs every
+// signature against it, so a game update can be validated without launching the game.
+//
+//   sigcheck [--game gz|tpp] [--json] [--threads N] <exe>...
+//
+// Exits 0 if every signature resolved exactly as the fix expects, 1 if any signature is missing or
+// ambiguous, 2 on usage or I/O errors.
+
+#include "pe.hpp"
+#include "scanner.hpp"
+#include "signatures.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double Milliseconds(Clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    // An exe laid out at its RVAs. Sections whose file offset and RVA are both page aligned are
+    // mapped straight from the file (copy-on-write, so no bytes are copied), the rest are read in.
+    class Image
+    {
+    public:
+        ~Image()
+        {
+            if (base != MAP_FAILED)
+                munmap(base, size);
+            if (fd >= 0)
+                close(fd);
+        }
+
+        bool Load(const std::filesystem::path& path, std::string& error)
+        {
+            fd = open(path.c_str(), O_RDONLY);
+            struct stat info{};
+            if (fd < 0 || fstat(fd, &info) != 0) {
+                error = "Can't open file.";
+                return false;
+            }
+            fileSize = static_cast<std::size_t>(info.st_size);
+
+            // Headers straight from the file to find SizeOfImage and the sections.
+            void* file = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (file == MAP_FAILED) {
+                error = "Can't map file.";
+                return false;
+            }
+            auto headers = PE::Parse(static_cast<const std::uint8_t*>(file), fileSize, false);
+            munmap(file, fileSize);
+            if (!headers || headers->SizeOfHeaders > fileSize || headers->SizeOfHeaders > headers->SizeOfImage) {
+                error = "Not a PE32+ image.";
+                return false;
+            }
+
+            size = headers->SizeOfImage;
+            base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (base == MAP_FAILED) {
+                error = "Can't reserve image.";
+                return false;
+            }
+
+            if (!Place(0, 0, headers->SizeOfHeaders, headers->SizeOfHeaders))
+                return Fail(error);
+            for (const auto& section : headers->Sections) {
+                std::size_t raw = section.RawOffset < fileSize ? std::min<std::size_t>(section.RawSize, fileSize - section.RawOffset) : 0;
+                if (!Place(section.VirtualAddress, section.RawOffset, std::min<std::size_t>(raw, section.VirtualSize), section.VirtualSize))
+                    return Fail(error);
+            }
+
+            info_ = PE::Parse(Base(), size);
+            if (!info_) {
+                error = "Image headers didn't survive layout.";
+                return false;
+            }
+            return true;
+        }
+
+        const std::uint8_t* Base() const { return static_cast<const std::uint8_t*>(base); }
+        const PE::ModuleInfo& Info() const { return *info_; }
+        std::size_t MappedSections() const { return mapped; }
+        std::size_t CopiedSections() const { return copied; }
+
+    private:
+        int fd = -1;
+        std::size_t fileSize = 0;
+        void* base = MAP_FAILED;
+        std::size_t size = 0;
+        std::optional<PE::ModuleInfo> info_;
+        std::size_t mapped = 0;
+        std::size_t copied = 0;
+
+        bool Fail(std::string& error)
+        {
+            error = "Can't lay out sections.";
+            return false;
+        }
+
+        // Puts rawSize file bytes at rva, the rest of virtualSize stays zero.
+        bool Place(std::uint32_t rva, std::uint32_t offset, std::size_t rawSize, std::size_t virtualSize)
+        {
+            if (!rawSize)
+                return true;
+
+            static const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+            std::uint8_t* target = static_cast<std::uint8_t*>(base) + rva;
+            if (rva % page == 0 && offset % page == 0) {
+                if (mmap(target, rawSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, offset) == MAP_FAILED)
+                    return false;
+
+                // The last mapped page carries whatever follows in the file, the loader zero fills it.
+                std::size_t mappedEnd = std::min((rawSize + page - 1) / page * page, size - rva);
+                std::size_t zeroEnd = std::min(mappedEnd, std::max(virtualSize, rawSize));
+                if (zeroEnd > rawSize)
+                    std::memset(target + rawSize, 0, zeroEnd - rawSize);
+                if (mappedEnd > zeroEnd)
+                    std::memset(target + zeroEnd, 0, mappedEnd - zeroEnd);
+                mapped++;
+                return true;
+            }
+
+            for (std::size_t done = 0; done < rawSize; ) {
+                ssize_t read = pread(fd, target + done, rawSize - done, offset + done);
+                if (read <= 0)
+                    return false;
+                done += static_cast<std::size_t>(read);
+            }
+            copied++;
+            return true;
+        }
+    };
+
+    struct Result
+    {
+        const Signatures::Signature* Signature;
+        std::vector<std::uint32_t> Rvas;
+        double ScanMs;
+
+        bool Ok() const { return Signature->All ? !Rvas.empty() : Rvas.size() == 1; }
+        const char* Status() const
+        {
+            if (Rvas.empty())
+                return "missing";
+            return Ok() ? "ok" : "ambiguous";
+        }
+    };
+
+    std::optional<Game> GameFromName(std::string name)
+    {
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (name == "gz" || name == "mgsgroundzeroes.exe")
+            return Game::GZ;
+        if (name == "tpp" || name == "mgsvtpp.exe")
+            return Game::TPP;
+        return std::nullopt;
+    }
+
+    std::string JsonString(std::string_view text)
+    {
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\')
+                out += '\\';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    int Usage()
+    {
+        std::fprintf(stderr, "Usage: sigcheck [--game gz|tpp] [--json] [--threads N] <exe>...\n");
+        return 2;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::optional<Game> forcedGame;
+    bool json = false;
+    unsigned threads = Scanner::DefaultThreads();
+    std::vector<std::filesystem::path> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--json")
+            json = true;
+        else if (arg == "--game" && i + 1 < argc) {
+            forcedGame = GameFromName(argv[++i]);
+            if (!forcedGame)
+                return Usage();
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = std::clamp(std::atoi(argv[++i]), 1, 64);
+        else if (arg.starts_with("--"))
+            return Usage();
+        else
+            files.emplace_back(arg);
+    }
+    if (files.empty())
+        return Usage();
+
+    int exitCode = 0;
+    if (json)
+        std::printf("[\n");
+
+    for (std::size_t fileIndex = 0; fileIndex < files.size(); ++fileIndex) {
+        const auto& path = files[fileIndex];
+        auto game = forcedGame ? forcedGame : GameFromName(path.filename().string());
+        if (!game) {
+            std::fprintf(stderr, "%s: Can't tell which game this is, pass --game.\n", path.string().c_str());
+            exitCode = 2;
+            continue;
+        }
+
+        auto loadStart = Clock::now();
+        Image image;
+        std::string error;
+        if (!image.Load(path, error)) {
+            std::fprintf(stderr, "%s: %s\n", path.string().c_str(), error.c_str());
+            exitCode = 2;
+            continue;
+        }
+        double loadMs = Milliseconds(Clock::now() - loadStart);
+
+        // Same ranges the fix scans in game: every executable section.
+        std::vector<Scanner::Region> regions;
+        std::size_t scanBytes = 0;
+        for (const auto& section : image.Info().Sections) {
+            if (section.Executable()) {
+                regions.push_back({ image.Base() + section.VirtualAddress, section.VirtualSize });
+                scanBytes += section.VirtualSize;
+            }
+        }
+
+        // Each signature on its own for timings and match counts...
+        std::vector<Result> results;
+        std::vector<std::pair<Scanner::Pattern, Scanner::Mode>> batch;
+        for (const auto* signature : Signatures::kAll) {
+            if (!Signatures::AppliesTo(*signature, *game))
+                continue;
+
+            auto scanStart = Clock::now();
+            auto matches = Scanner::FindAllParallel(regions, signature->Pattern, threads);
+            Result result{ signature, {}, Milliseconds(Clock::now() - scanStart) };
+            for (const std::uint8_t* match : matches)
+                result.Rvas.push_back(static_cast<std::uint32_t>(match - image.Base()));
+            results.push_back(std::move(result));
+            batch.emplace_back(signature->Pattern, signature->All ? Scanner::Mode::All : Scanner::Mode::First);
+        }
+
+        // ...and all of them in one pass, the way the fix resolves them at startup.
+        auto batchStart = Clock::now();
+        Scanner::ScanMultiParallel(Scanner::BuildMultiPattern(batch), regions, threads);
+        double batchMs = Milliseconds(Clock::now() - batchStart);
+
+        std::size_t failed = std::count_if(results.begin(), results.end(), [](const Result& result) { return !result.Ok(); });
+        if (failed)
+            exitCode = std::max(exitCode, 1);
+
+        const char* gameName = *game == Game::GZ ? "GZ" : "TPP";
+        auto timestamp = image.Info().Timestamp;
+        if (json) {
+            std::printf("  {\n    \"file\": %s,\n    \"game\": \"%s\",\n    \"timestamp\": \"%08x\",\n", JsonString(path.string()).c_str(), gameName, timestamp);
+            std::printf("    \"scan_bytes\": %zu,\n    \"threads\": %u,\n    \"load_ms\": %.3f,\n    \"batch_scan_ms\": %.3f,\n    \"failed\": %zu,\n    \"signatures\": [\n", scanBytes, threads, loadMs, batchMs, failed);
+            for (std::size_t i = 0; i < results.size(); ++i) {
+                const auto& result = results[i];
+                std::printf("      { \"name\": %s, \"status\": \"%s\", \"all\": %s, \"matches\": %zu, \"scan_ms\": %.3f, \"rvas\": [", JsonString(result.Signature->Name).c_str(), result.Status(), result.Signature->All ? "true" : "false", result.Rvas.size(), result.ScanMs);
+                for (std::size_t j = 0; j < result.Rvas.size(); ++j)
+                    std::printf("%s\"%x\"", j ? ", " : "", result.Rvas[j]);
+                std::printf("] }%s\n", i + 1 < results.size() ? "," : "");
+            }
+            std::printf("    ]\n  }%s\n", fileIndex + 1 < files.size() ? "," : "");
+        }
+        else {
+            std::printf("%s (%s, timestamp %08x)\n", path.string().c_str(), gameName, timestamp);
+            std::printf("  Loaded in %.2fms (%zu sections mapped, %zu read), scanning %zu bytes in %zu executable ranges.\n", loadMs, image.MappedSections(), image.CopiedSections(), scanBytes, regions.size());
+            for (const auto& result : results) {
+                std::printf("  %-9s %-52s %3zu match(es) %8.3fms", result.Status(), result.Signature->Name, result.Rvas.size(), result.ScanMs);
+                for (std::size_t j = 0; j < result.Rvas.size() && j < 4; ++j)
+                    std::printf(" +%x", result.Rvas[j]);
+                if (result.Rvas.size() > 4)
+                    std::printf(" ...");
+                std::printf("\n");
+            }
+            std::printf("  %zu/%zu signatures OK, batch scan %.2fms with %u thread(s).\n\n", results.size() - failed, results.size(), batchMs, threads);
+        }
+    }
+
+    if (json)
+        std::printf("]\n");
+    return exitCode;
+}
@@ -0,0 +1,227 @@
+// Runs the thread policy planner against made-up CPUs and checks the plans make sense, so planner
+// changes can be checked without the hardware.
+//
+//   topoplan [Thread=Placement[,Priority]]...
+//
+// Without rules, a mix of every placement is planned. Each plan is checked: masks only name
+// processors the machine has, pinned threads get distinct whole cores on the fast cores of the
+// expected L3 domain, shared placements stay off pinned cores while there are others, and Efficiency
+// stays on the slower cores of that domain when it has any.
+// Exits 0 if every plan passes, 1 if any check fails, 2 on usage errors.
+
+#include "topology.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    struct Synthetic
+    {
+        const char* Name;
+        Topology::Machine Machine;
+        std::uint8_t ExpectedDomain;
+    };
+
+    // Adds cores logical processors at a time. SMT siblings get consecutive indices, like Windows reports them.
+    void AddCores(Topology::Machine& machine, int cores, int threadsPerCore, std::uint8_t efficiency, std::uint8_t domain)
+    {
+        std::uint8_t core = machine.Processors.empty() ? 0 : machine.Processors.back().Core + 1;
+        for (int i = 0; i < cores; ++i, ++core) {
+            for (int thread = 0; thread < threadsPerCore; ++thread)
+                machine.Processors.push_back({ static_cast<std::uint8_t>(machine.Processors.size()), core, efficiency, domain });
+        }
+    }
+
+    std::vector<Synthetic> Machines()
+    {
+        std::vector<Synthetic> machines;
+
+        Synthetic desktop{ "8 cores, SMT, one L3", {}, 0 };
+        AddCores(desktop.Machine, 8, 2, 0, 0);
+        desktop.Machine.DomainCacheKB = { 32768 };
+        machines.push_back(desktop);
+
+        Synthetic dualCCD{ "16 cores, SMT, two equal CCDs", {}, 0 };
+        AddCores(dualCCD.Machine, 8, 2, 0, 0);
+        AddCores(dualCCD.Machine, 8, 2, 0, 1);
+        dualCCD.Machine.DomainCacheKB = { 32768, 32768 };
+        machines.push_back(dualCCD);
+
+        // V-cache on the second CCD, to check cache size wins over order.
+        Synthetic x3d{ "16 cores, SMT, V-cache on CCD 1", {}, 1 };
+        AddCores(x3d.Machine, 8, 2, 0, 0);
+        AddCores(x3d.Machine, 8, 2, 0, 1);
+        x3d.Machine.DomainCacheKB = { 32768, 98304 };
+        machines.push_back(x3d);
+
+        Synthetic hybrid{ "8 P-cores with SMT, 16 E-cores", {}, 0 };
+        AddCores(hybrid.Machine, 8, 2, 1, 0);
+        AddCores(hybrid.Machine, 16, 1, 0, 0);
+        hybrid.Machine.DomainCacheKB = { 36864 };
+        machines.push_back(hybrid);
+
+        // Low power E-cores outside the L3, listed first.
+        Synthetic mobile{ "2 LP E-cores, 8 E-cores, 6 P-cores with SMT", {}, 0 };
+        AddCores(mobile.Machine, 2, 1, 0, 0xFF);
+        AddCores(mobile.Machine, 8, 1, 1, 0);
+        AddCores(mobile.Machine, 6, 2, 2, 0);
+        mobile.Machine.DomainCacheKB = { 24576 };
+        machines.push_back(mobile);
+
+        Synthetic quad{ "4 cores, no SMT", {}, 0 };
+        AddCores(quad.Machine, 4, 1, 0, 0);
+        quad.Machine.DomainCacheKB = { 8192 };
+        machines.push_back(quad);
+
+        Synthetic dual{ "2 cores, no SMT", {}, 0 };
+        AddCores(dual.Machine, 2, 1, 0, 0);
+        dual.Machine.DomainCacheKB = { 4096 };
+        machines.push_back(dual);
+
+        return machines;
+    }
+
+    const char* PlacementName(Topology::Placement place)
+    {
+        switch (place) {
+        case Topology::Placement::Any:          return "Any";
+        case Topology::Placement::Performance:  return "Performance";
+        case Topology::Placement::Efficiency:   return "Efficiency";
+        case Topology::Placement::Pin:          return "Pin";
+        }
+        return "?";
+    }
+
+    // Returns the number of failed checks, printing each.
+    int Check(const Synthetic& synthetic, const std::vector<Topology::Rule>& rules, const std::vector<Topology::Assignment>& plan)
+    {
+        const auto& machine = synthetic.Machine;
+        int failures = 0;
+        auto fail = [&](const std::string& thread, const char* what) {
+            std::printf("    FAIL %s: %s\n", thread.c_str(), what);
+            failures++;
+        };
+
+        std::uint8_t fastest = 0;
+        for (const auto& processor : machine.Processors)
+            fastest = std::max(fastest, processor.Efficiency);
+        auto processorsOf = [&](std::uint64_t mask) {
+            std::vector<const Topology::Processor*> processors;
+            for (const auto& processor : machine.Processors) {
+                if (mask & (std::uint64_t(1) << processor.Index))
+                    processors.push_back(&processor);
+            }
+            return processors;
+        };
+
+        if (Topology::BestDomain(machine) != synthetic.ExpectedDomain)
+            fail("(machine)", "picked the wrong L3 domain");
+
+        // Hybrid parts with slower cores sharing the best L3 should keep Efficiency threads on them.
+        bool slowerInDomain = std::any_of(machine.Processors.begin(), machine.Processors.end(), [&](const Topology::Processor& processor) {
+            return processor.Domain == synthetic.ExpectedDomain && processor.Efficiency != fastest;
+        });
+
+        std::uint64_t pinned = 0;
+        for (std::size_t i = 0; i < plan.size(); ++i) {
+            const auto& assignment = plan[i];
+            if (assignment.Mask & ~machine.All())
+                fail(assignment.Thread, "mask names processors the machine doesn't have");
+            if (rules[i].Place != Topology::Placement::Pin || assignment.Reason.starts_with("no core"))
+                continue;
+
+            auto processors = processorsOf(assignment.Mask);
+            if (processors.empty()) {
+                fail(assignment.Thread, "pinned to nothing");
+                continue;
+            }
+            for (const auto* processor : processors) {
+                if (processor->Core != processors.front()->Core)
+                    fail(assignment.Thread, "pinned across more than one core");
+                if (processor->Efficiency != fastest || processor->Domain != synthetic.ExpectedDomain)
+                    fail(assignment.Thread, "pinned outside the fast cores of the best domain");
+            }
+            for (const auto& processor : machine.Processors) {
+                if (processor.Core == processors.front()->Core && !(assignment.Mask & (std::uint64_t(1) << processor.Index)))
+                    fail(assignment.Thread, "pinned to part of a core");
+            }
+            if (pinned & assignment.Mask)
+                fail(assignment.Thread, "shares its pinned core");
+            pinned |= assignment.Mask;
+        }
+
+        for (std::size_t i = 0; i < plan.size(); ++i) {
+            const auto& assignment = plan[i];
+            if (rules[i].Place == Topology::Placement::Any && assignment.Mask)
+                fail(assignment.Thread, "Any changed the affinity");
+            if (rules[i].Place == Topology::Placement::Performance) {
+                auto mask = assignment.Mask ? assignment.Mask : machine.All();
+                for (const auto* processor : processorsOf(mask)) {
+                    if (processor->Efficiency != fastest)
+                        fail(assignment.Thread, "Performance includes a slower core");
+                }
+                if ((mask & pinned) && (mask & ~pinned))
+                    fail(assignment.Thread, "Performance overlaps a pinned core");
+            }
+            if (rules[i].Place == Topology::Placement::Efficiency && assignment.Mask && (assignment.Mask & pinned))
+                fail(assignment.Thread, "Efficiency overlaps a pinned core");
+            if (rules[i].Place == Topology::Placement::Efficiency && slowerInDomain) {
+                for (const auto* processor : processorsOf(assignment.Mask)) {
+                    if (processor->Domain != synthetic.ExpectedDomain || processor->Efficiency == fastest)
+                        fail(assignment.Thread, "Efficiency left the L3 domain's slower cores");
+                }
+            }
+        }
+        return failures;
+    }
+
+    int Usage()
+    {
+        std::fprintf(stderr, "Usage: topoplan [Thread=Placement[,Priority]]...\n");
+        return 2;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<Topology::Rule> rules;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        auto equals = arg.find('=');
+        auto rule = equals == std::string_view::npos ? std::nullopt : Topology::ParseRule(arg.substr(0, equals), arg.substr(equals + 1));
+        if (!rule)
+            return Usage();
+        rules.push_back(*rule);
+    }
+    if (rules.empty()) {
+        for (const char* rule : { "MainThrd=Pin,Highest", "RenderThrd=Pin,AboveNormal", "Streaming=Performance", "Workers=Efficiency,BelowNormal", "Audio=Any,Highest" }) {
+            std::string_view text = rule;
+            auto equals = text.find('=');
+            rules.push_back(*Topology::ParseRule(text.substr(0, equals), text.substr(equals + 1)));
+        }
+    }
+
+    int failures = 0;
+    for (const auto& synthetic : Machines()) {
+        std::printf("%s (%zu logical processors, best L3 domain %d):\n", synthetic.Name, synthetic.Machine.Processors.size(), Topology::BestDomain(synthetic.Machine));
+        auto plan = Topology::Plan(synthetic.Machine, rules);
+        for (std::size_t i = 0; i < plan.size(); ++i) {
+            char mask[24] = "unchanged";
+            if (plan[i].Mask)
+                std::snprintf(mask, sizeof(mask), "0x%llx", static_cast<unsigned long long>(plan[i].Mask));
+            std::string priority = plan[i].Priority ? std::to_string(*plan[i].Priority) : "-";
+            std::printf("  %-12s %-12s mask %-18s %2d processor(s), priority %-2s  %s\n", plan[i].Thread.c_str(), PlacementName(rules[i].Place),
+                        mask, std::popcount(plan[i].Mask), priority.c_str(), plan[i].Reason.c_str());
+        }
+        failures += Check(synthetic, rules, plan);
+    }
+
+    std::printf("%s\n", failures ? "Some plans failed their checks." : "All plans passed.");
+    return failures ? 1 : 0;
+}
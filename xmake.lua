@@ -3,10 +3,18 @@ add_rules("mode.debug", "mode.release")
 set_languages("cxxlatest", "clatest")
 set_optimize("faster")
 
+option("profile")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Build with per-hook call counters and cost profiling")
+    add_defines("MGSVFIX_PROFILE")
+option_end()
+
   target("MGSVFix")
     set_kind("shared")
     add_files("src/**.cpp", "external/safetyhook/safetyhook.cpp", "external/safetyhook/Zydis.c")
     add_syslinks("user32")
+    add_options("profile")
     add_includedirs("external/spdlog/include", "external/inipp", "external/safetyhook")
     set_prefixname("")
     set_extension(".asi")
@@ -21,3 +29,55 @@ set_optimize("faster")
       add_cxflags("/MTd")
     end
   end
+
+  -- Offline signature checker for game exes on disk (POSIX only): xmake build sigcheck
+  target("sigcheck")
+    set_kind("binary")
+    set_default(false)
+    add_files("tools/sigcheck.cpp")
+    add_includedirs("src")
+    add_syslinks("pthread")
+
+  -- Replays a hook capture through the mid hook callbacks (POSIX only): xmake build hookreplay
+  target("hookreplay")
+    set_kind("binary")
+    set_default(false)
+    add_files("tools/hookreplay.cpp")
+    add_includedirs("src", "external/safetyhook")
+    add_syslinks("pthread")
+
+  -- Runs the LOD governor against frame time traces (POSIX only): xmake build lodsim
+  target("lodsim")
+    set_kind("binary")
+    set_default(false)
+    add_files("tools/lodsim.cpp")
+    add_includedirs("src")
+
+  -- Checks the thread policy planner against synthetic CPU topologies: xmake build topoplan
+  target("topoplan")
+    set_kind("binary")
+    set_default(false)
+    add_files("tools/topoplan.cpp")
+    add_includedirs("src")
+
+  -- Times and checks the lean mid hook stubs (POSIX x86-64 only): xmake build midstubbench
+  target("midstubbench")
+    set_kind("binary")
+    set_default(false)
+    add_files("tools/midstubbench.cpp")
+    add_includedirs("external/safetyhook")
+
+  -- Times the pattern scanners and the parallel scan thread sweep on a synthetic image: xmake build scanbench
+  target("scanbench")
+    set_kind("binary")
+    set_default(false)
+    add_files("tools/scanbench.cpp")
+    add_includedirs("src")
+    add_syslinks("pthread")
+
+  -- Measures the frame limiter's wake-up lateness headless: xmake build pacesim
+  target("pacesim")
+    set_kind("binary")
+    set_default(false)
+    add_files("tools/pacesim.cpp")
+    add_includedirs("src")